@@ -0,0 +1,100 @@
+#include "audio.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+Audio::Audio() : device(0), sampleRate(48000), tone(), patternPhase(0.0), envelope(0.0f), samplesSinceTone(0), muted(false) {}
+
+bool Audio::Init()
+{
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        std::cout << "SDL audio could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Mono 16-bit with a small device buffer (256 samples = ~5ms at 48kHz)
+    SDL_AudioSpec desired = {};
+    desired.freq = 48000;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = 1;
+    desired.samples = 256;
+    desired.callback = Callback;
+    desired.userdata = this;
+
+    SDL_AudioSpec obtained = {};
+    device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (device == 0) {
+        std::cout << "Failed to open audio device: " << SDL_GetError() << std::endl;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    sampleRate = obtained.freq;
+    samplesSinceTone = sampleRate;
+
+    SDL_PauseAudioDevice(device, 0);
+    return true;
+}
+
+void Audio::Produce(const Chip8& chip8)
+{
+    if (device == 0) return;
+
+    Tone next;
+    next.on = chip8.soundTimer > 0 && !muted;
+    next.pitch = chip8.audioPitch;
+    std::copy(chip8.audioPattern, chip8.audioPattern + AUDIO_PATTERN_SIZE, next.pattern);
+    ring.Push(&next, 1);
+}
+
+void Audio::Callback(void* userdata, Uint8* stream, int len)
+{
+    Audio* audio = static_cast<Audio*>(userdata);
+    audio->Fill(reinterpret_cast<int16_t*>(stream), len / static_cast<int>(sizeof(int16_t)));
+}
+
+void Audio::Fill(int16_t* out, int count)
+{
+    // Take the newest tick. A beep only a tick long still sounds if a later tick arrived with it.
+    Tone ticks[decltype(ring)::capacity];
+    size_t got = ring.Pop(ticks, decltype(ring)::capacity);
+    if (got > 0) {
+        bool anyOn = std::any_of(ticks, ticks + got, [](const Tone& t) { return t.on; });
+        tone = ticks[got - 1];
+        tone.on = anyOn;
+        samplesSinceTone = 0;
+    }
+
+    // No tick for two frames: fade out rather than hold the last tone
+    bool soundOn = tone.on && samplesSinceTone < sampleRate / 30;
+    if (samplesSinceTone < sampleRate) samplesSinceTone += count;
+
+    // XO-CHIP playback rate: 4000 pattern bits per second at pitch 64, an octave per 48 steps
+    double bitsPerSecond = 4000.0 * std::pow(2.0, (tone.pitch - 64) / 48.0);
+    double step = bitsPerSecond / sampleRate;
+
+    const float envelopeStep = 1000.0f / sampleRate; // 1ms ramp
+    const float amplitude = 4000.0f;
+
+    for (int i = 0; i < count; i++) {
+        unsigned int bit = static_cast<unsigned int>(patternPhase) & 127;
+        bool high = (tone.pattern[bit >> 3] >> (7 - (bit & 7))) & 1;
+
+        if (soundOn) envelope = std::min(1.0f, envelope + envelopeStep);
+        else envelope = std::max(0.0f, envelope - envelopeStep);
+
+        out[i] = static_cast<int16_t>((high ? amplitude : -amplitude) * envelope);
+
+        patternPhase += step;
+        if (patternPhase >= 128.0) patternPhase -= 128.0;
+    }
+}
+
+void Audio::Shutdown()
+{
+    if (device != 0) {
+        SDL_CloseAudioDevice(device);
+        device = 0;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include "chip8.h"
+#include "spsc_ring.h"
+
+// Sound timer / XO-CHIP pattern playback.
+// Each 60Hz timer tick the emulation side hands the audio callback what to
+// play (sound on or off, pattern, pitch) through a lock-free ring, and the
+// callback synthesises its buffer from the latest one: no locks, no
+// allocation. Samples are only ever made one device buffer ahead, so a beep
+// starts within two device buffers (~11ms at 48kHz) of its tick, however
+// often the main loop runs.
+class Audio
+{
+    // What to play until the next tick
+    struct Tone
+    {
+        bool on;
+        uint8_t pitch;
+        uint8_t pattern[AUDIO_PATTERN_SIZE];
+    };
+
+    SDL_AudioDeviceID device;
+    int sampleRate;
+
+    // A few ticks of slack in case the callback is late
+    SpscRing<Tone, 16> ring;
+
+    // Consumer state (audio callback)
+    Tone tone;               // the latest tick's
+    double patternPhase;     // position in the 128-bit pattern
+    float envelope;          // short ramp on start/stop so beeps don't click
+    int samplesSinceTone;    // the sound stops if the ticks do (paused, or the main loop stalled)
+
+    static void Callback(void* userdata, Uint8* stream, int len);
+    void Fill(int16_t* out, int count);
+
+public:
+    Audio();
+
+    // Open the default output device. Returns false (and emulation carries on silently) if there isn't one.
+    bool Init();
+
+    // Queue this timer tick's sound timer/pattern/pitch for the callback
+    void Produce(const Chip8& chip8);
+
+    void Shutdown();
+
+    // Ticks waiting for the callback (for the performance panel); 0 or 1 when it keeps up
+    size_t QueuedTicks() const { return ring.Size(); }
+
+    bool muted;
+};
@@ -2,12 +2,90 @@
 #include "imgui.h"
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_sdlrenderer2.h"
+#include "trace.h"
 #include <iomanip>
 #include <sstream>
 #include <iostream>
 #include <cstdio>
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+#include "rom.h"
 
-Graphics::Graphics() : showRegisters(true), showMemory(true), showControls(true), showCPUState(true), showKeyboard(true), showDisassembly(true), showDisplay(true), window(nullptr), renderer(nullptr), displayTexture(nullptr), isPaused(false), isStep(false), isReset(false), romLoadRequested(false), selectedRomIndex(-1) {}
+Graphics::Graphics() : showRegisters(true), showMemory(true), showControls(true), showCPUState(true), showKeyboard(true), showDisassembly(true), showDisplay(true), showBreakpoints(false), showPerformance(false), window(nullptr), renderer(nullptr), displayTexture(nullptr), displayScale(10), displayTextureScale(0), scalerMicros(0), isPaused(false), isStep(false), isReset(false), playerMode(false), romScanPending(false), romLoadRequested(false), hotReloadMode(HotReload::Restart), vipTiming(false), romFilter{}, captureFormat(0), captureTarget("capture"), memoryStart(0x200), memoryFollowPC(false), disassemblyFocus(-1), analysisPending(false), analysisVariant(Variant::Chip8), latencyPending(false), latencyDisplayHash(0), tracePath("chip8_trace.json")
+{
+    // Default bindings by physical position: the left 4x4 block of a QWERTY keyboard
+    static const struct { SDL_Scancode scancode; int8_t key; } defaultKeys[] = {
+        { SDL_SCANCODE_1, 0x1 }, { SDL_SCANCODE_2, 0x2 }, { SDL_SCANCODE_3, 0x3 }, { SDL_SCANCODE_4, 0xC },
+        { SDL_SCANCODE_Q, 0x4 }, { SDL_SCANCODE_W, 0x5 }, { SDL_SCANCODE_E, 0x6 }, { SDL_SCANCODE_R, 0xD },
+        { SDL_SCANCODE_A, 0x7 }, { SDL_SCANCODE_S, 0x8 }, { SDL_SCANCODE_D, 0x9 }, { SDL_SCANCODE_F, 0xE },
+        { SDL_SCANCODE_Z, 0xA }, { SDL_SCANCODE_X, 0x0 }, { SDL_SCANCODE_C, 0xB }, { SDL_SCANCODE_V, 0xF },
+    };
+    std::fill(std::begin(scancodeKeys), std::end(scancodeKeys), -1);
+    for (const auto& binding : defaultKeys) {
+        scancodeKeys[binding.scancode] = binding.key;
+    }
+}
+
+bool Graphics::LoadKeyMap(const std::string& path, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file) {
+        error = "Failed to open key map: " + path;
+        return false;
+    }
+
+    // Each line: a keypad key in hex, then one or more SDL scancode names ("Q", "Keypad 7", "Up"...),
+    // separated by commas so names with spaces work. '#' starts a comment.
+    int8_t keys[SDL_NUM_SCANCODES];
+    std::fill(std::begin(keys), std::end(keys), -1);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string keyText;
+        if (!(in >> keyText)) continue;
+
+        char* end = nullptr;
+        unsigned long key = std::strtoul(keyText.c_str(), &end, 16);
+        if (*end || key > 0xF) {
+            error = path + ":" + std::to_string(lineNumber) + ": bad keypad key '" + keyText + "'";
+            return false;
+        }
+
+        std::string names;
+        std::getline(in, names);
+        std::istringstream list(names);
+        std::string name;
+        while (std::getline(list, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t\r") + 1);
+            if (name.empty()) continue;
+            SDL_Scancode scancode = SDL_GetScancodeFromName(name.c_str());
+            if (scancode == SDL_SCANCODE_UNKNOWN) {
+                error = path + ":" + std::to_string(lineNumber) + ": unknown key '" + name + "'";
+                return false;
+            }
+            keys[scancode] = (int8_t)key;
+        }
+    }
+
+    std::copy(std::begin(keys), std::end(keys), scancodeKeys);
+    return true;
+}
+
+void Graphics::KeyApplied(const KeyEventQueue::Event& event, const Chip8& chip8)
+{
+    Metrics::Add(metrics.keyEvents, 1);
+
+    // Time presses only, from the first one since the last measurement finished
+    if (!event.pressed || latencyPending) return;
+    latencyPending = true;
+    latencyStart = event.time;
+    latencyDisplayHash = HashRom(reinterpret_cast<const uint8_t*>(chip8.display), sizeof(chip8.display));
+}
 
 bool Graphics::Init(int width, int height)
 {
@@ -35,13 +113,6 @@ bool Graphics::Init(int width, int height)
         return false;
     }
     
-    // Create texture for CHIP-8 display with proper format
-    displayTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, 64, 32);
-    if (!displayTexture) {
-        std::cout << "Failed to create display texture: " << SDL_GetError() << std::endl;
-        return false;
-    }
-    
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -56,6 +127,11 @@ bool Graphics::Init(int width, int height)
     
     // Setup initial window layout
     SetupWindowLayout();
+
+    // Started with --player
+    if (playerMode) {
+        SetPlayerMode(true);
+    }
     
     return true;
 }
@@ -131,6 +207,7 @@ void Graphics::SetupWindowLayout()
 
 void Graphics::RenderOrganizedLayout(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderOrganizedLayout");
     // CPU State Window (top-left) - Always set position and size
     if (showCPUState) {
         ImGui::SetNextWindowPos(cpuStatePos, ImGuiCond_Always);
@@ -179,11 +256,28 @@ void Graphics::RenderOrganizedLayout(Chip8& chip8)
         ImGui::SetNextWindowSize(disassemblySize, ImGuiCond_Always);
         RenderDisassembly(chip8);
     }
+    
+    // Breakpoints Window (floating, not part of the fixed grid)
+    if (showBreakpoints) {
+        ImGui::SetNextWindowPos(ImVec2(disassemblyPos.x - 330.0f, disassemblyPos.y), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(320.0f, 300.0f), ImGuiCond_FirstUseEver);
+        RenderBreakpoints(chip8);
+    }
+
+    // Performance Window (floating)
+    if (showPerformance) {
+        ImGui::SetNextWindowPos(ImVec2(controlsPos.x + controlsSize.x + 10.0f, controlsPos.y), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(340.0f, 360.0f), ImGuiCond_FirstUseEver);
+        RenderPerformance();
+    }
 }
 
 void Graphics::ProcessEvent(SDL_Event* event)
 {
-    ImGui_ImplSDL2_ProcessEvent(event);
+    // No ImGui frames are built in player mode, so don't queue input for them
+    if (!playerMode) {
+        ImGui_ImplSDL2_ProcessEvent(event);
+    }
 }
 
 bool Graphics::HandleInput(SDL_Event* event, Chip8& chip8)
@@ -191,28 +285,22 @@ bool Graphics::HandleInput(SDL_Event* event, Chip8& chip8)
     if (event->type == SDL_QUIT) {
         return false; // Signal to quit
     }
+
+    // F11 toggles player mode and Escape leaves it, unless the key map gives them to the keypad
+    if (event->type == SDL_KEYDOWN && !event->key.repeat && scancodeKeys[event->key.keysym.scancode] < 0) {
+        if (event->key.keysym.scancode == SDL_SCANCODE_F11 || (playerMode && event->key.keysym.scancode == SDL_SCANCODE_ESCAPE)) {
+            SetPlayerMode(event->key.keysym.scancode == SDL_SCANCODE_F11 && !playerMode);
+            return true;
+        }
+    }
     
-    // Handle keyboard input for CHIP-8
-    if (event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) {
-        bool keyPressed = (event->type == SDL_KEYDOWN);
-        
-        switch (event->key.keysym.sym) {
-            case SDLK_1: chip8.keypad[0x1] = keyPressed; break;
-            case SDLK_2: chip8.keypad[0x2] = keyPressed; break;
-            case SDLK_3: chip8.keypad[0x3] = keyPressed; break;
-            case SDLK_4: chip8.keypad[0xC] = keyPressed; break;
-            case SDLK_q: chip8.keypad[0x4] = keyPressed; break;
-            case SDLK_w: chip8.keypad[0x5] = keyPressed; break;
-            case SDLK_e: chip8.keypad[0x6] = keyPressed; break;
-            case SDLK_r: chip8.keypad[0xD] = keyPressed; break;
-            case SDLK_a: chip8.keypad[0x7] = keyPressed; break;
-            case SDLK_s: chip8.keypad[0x8] = keyPressed; break;
-            case SDLK_d: chip8.keypad[0x9] = keyPressed; break;
-            case SDLK_f: chip8.keypad[0xE] = keyPressed; break;
-            case SDLK_z: chip8.keypad[0xA] = keyPressed; break;
-            case SDLK_x: chip8.keypad[0x0] = keyPressed; break;
-            case SDLK_c: chip8.keypad[0xB] = keyPressed; break;
-            case SDLK_v: chip8.keypad[0xF] = keyPressed; break;
+    // Queue keypad changes stamped with when SDL saw them, so the main loop can apply each one
+    // at the instruction it happened during rather than at the start of the next batch
+    if ((event->type == SDL_KEYDOWN || event->type == SDL_KEYUP) && !event->key.repeat) {
+        int8_t key = scancodeKeys[event->key.keysym.scancode];
+        if (key >= 0) {
+            Uint32 age = SDL_GetTicks() - event->key.timestamp;
+            keyEvents.Push((uint8_t)key, event->type == SDL_KEYDOWN, KeyEventQueue::Clock::now() - std::chrono::milliseconds(age));
         }
     }
     
@@ -221,10 +309,11 @@ bool Graphics::HandleInput(SDL_Event* event, Chip8& chip8)
 
 void Graphics::RenderCPUState(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderCPUState");
     ImGui::Begin("CHIP-8 - CPU State", &showCPUState, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     
     // Get current instruction
-    uint16_t instruction = (chip8.memory[chip8.pc] << 8) | chip8.memory[chip8.pc + 1];
+    uint16_t instruction = (chip8.Read(chip8.pc) << 8) | chip8.Read(chip8.pc + 1);
     
     // CPU State section
     ImGui::SeparatorText("CPU Registers");
@@ -247,6 +336,10 @@ void Graphics::RenderCPUState(Chip8& chip8)
     ImGui::Text("%s", decoded.c_str());
     ImGui::PopStyleColor();
     
+    ImGui::SeparatorText("Display");
+    ImGui::Text("Mode:"); ImGui::SameLine(80); ImGui::Text("%s %ux%u", chip8.hires ? "Hi-res" : "Lo-res", chip8.DisplayWidth(), chip8.DisplayHeight());
+    ImGui::Text("Planes:"); ImGui::SameLine(80); ImGui::Text("0x%X", chip8.planeMask);
+    
     ImGui::SeparatorText("Timers");
     ImGui::Text("Delay:"); ImGui::SameLine(80); ImGui::Text("%d", chip8.delayTimer);
     ImGui::Text("Sound:"); ImGui::SameLine(80); ImGui::Text("%d", chip8.soundTimer);
@@ -280,6 +373,7 @@ void Graphics::RenderCPUState(Chip8& chip8)
 
 void Graphics::RenderRegisters(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderRegisters");
     ImGui::Begin("CHIP-8 - Registers", &showRegisters, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     
     ImGui::SeparatorText("General Purpose Registers");
@@ -314,19 +408,17 @@ void Graphics::RenderRegisters(Chip8& chip8)
 
 void Graphics::RenderMemory(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderMemory");
     ImGui::Begin("CHIP-8 - Memory", &showMemory, ImGuiWindowFlags_NoMove);
     
-    static int memoryStart = 0x200; // Start at ROM area
-    static bool followPC = false;
-    
-    ImGui::Checkbox("Follow PC", &followPC);
+    ImGui::Checkbox("Follow PC", &memoryFollowPC);
     ImGui::SameLine();
     
-    if (followPC) {
+    if (memoryFollowPC) {
         memoryStart = (chip8.pc / 16) * 16; // Align to 16-byte boundary
     }
     
-    ImGui::SliderInt("Start Address", &memoryStart, 0, 4096-256, "0x%04X");
+    ImGui::SliderInt("Start Address", &memoryStart, 0, MEMORY_SIZE-256, "0x%04X");
     
     ImGui::SeparatorText("Memory View");
     
@@ -350,18 +442,18 @@ void Graphics::RenderMemory(Chip8& chip8)
     
     for (int i = 0; i < 16; i++) {
         int addr = memoryStart + i * 16;
-        if (addr >= 4096) break;
+        if (addr >= (int)MEMORY_SIZE) break;
         
         // Address column
         ImGui::Text("0x%04X: ", addr);
         ImGui::SameLine();
         
         // Hex values
-        for (int j = 0; j < 16 && (addr + j) < 4096; j++) {
+        for (int j = 0; j < 16 && (addr + j) < (int)MEMORY_SIZE; j++) {
             ImGui::SameLine();
-            uint8_t byte = chip8.memory[addr + j];
+            uint8_t byte = chip8.Read(addr + j);
             
-            // Highlight PC location and next instruction
+            // Highlight PC location and next instruction, then watched bytes
             if (addr + j == chip8.pc) {
                 ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.0f, 1.0f));
                 ImGui::Text("%02X", byte);
@@ -370,6 +462,10 @@ void Graphics::RenderMemory(Chip8& chip8)
                 ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.8f, 0.0f, 1.0f));
                 ImGui::Text("%02X", byte);
                 ImGui::PopStyleColor();
+            } else if (debugger.readWatch.test(addr + j) || debugger.writeWatch.test(addr + j)) {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+                ImGui::Text("%02X", byte);
+                ImGui::PopStyleColor();
             } else {
                 ImGui::Text("%02X", byte);
             }
@@ -380,9 +476,9 @@ void Graphics::RenderMemory(Chip8& chip8)
         ImGui::SameLine();
         
         // ASCII representation
-        for (int j = 0; j < 16 && (addr + j) < 4096; j++) {
+        for (int j = 0; j < 16 && (addr + j) < (int)MEMORY_SIZE; j++) {
             ImGui::SameLine();
-            uint8_t byte = chip8.memory[addr + j];
+            uint8_t byte = chip8.Read(addr + j);
             char c = (byte >= 32 && byte < 127) ? byte : '.';
             
             if (addr + j == chip8.pc || addr + j == chip8.pc + 1) {
@@ -402,6 +498,7 @@ void Graphics::RenderMemory(Chip8& chip8)
 
 void Graphics::RenderControls(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderControls");
     ImGui::Begin("CHIP-8 - Controls", &showControls, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     
     ImGui::SeparatorText("Execution Control");
@@ -416,6 +513,11 @@ void Graphics::RenderControls(Chip8& chip8)
     if (ImGui::Button(isPaused ? "Resume" : "Pause", ImVec2(80, 30))) {
         isPaused = !isPaused;
         isStep = false;
+
+        // Don't stop again on the breakpoint we're sitting on
+        if (!isPaused) {
+            debugger.Resume();
+        }
     }
     
     ImGui::SameLine();
@@ -446,10 +548,78 @@ void Graphics::RenderControls(Chip8& chip8)
     static float emulationSpeed = 1.0f;
     ImGui::SliderFloat("##Speed", &emulationSpeed, 0.1f, 10.0f, "%.1fx");
     
+    ImGui::Text("Variant:");
+    int variant = (int)chip8.variant;
+    const char* variantNames[VARIANT_COUNT] = { VariantName(Variant::Chip8), VariantName(Variant::SuperChip), VariantName(Variant::XoChip) };
+    if (ImGui::Combo("##Variant", &variant, variantNames, VARIANT_COUNT)) {
+        chip8.variant = (Variant)variant;
+        chip8.waitingForVBlank = false;
+    }
+
+    // A run is timed one way from the start, so switching restarts the ROM
+    if (ImGui::Checkbox("COSMAC VIP timing", &vipTiming)) {
+        isReset = true;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Each instruction takes the machine cycles it took on a VIP, and the\n60Hz interrupt (timers, DXYN's wait) lands on its exact cycle.\nSpeed then comes from the VIP's clock, not the cycle delay.");
+    }
+    
+    // Even sizes only, so hi-res pixels are whole screen pixels too
     ImGui::Text("Display Scale:");
-    static int displayScale = 10;
-    ImGui::SliderInt("##Scale", &displayScale, 1, 20);
+    if (ImGui::SliderInt("##Scale", &displayScale, 2, 20)) {
+        SetDisplayScale(displayScale);
+    }
+    if (ImGui::TreeNode("Palette")) {
+        // One colour per combination of XO-CHIP planes; plain CHIP-8 only uses the first two
+        for (int i = 0; i < 16; i++) {
+            uint32_t& colour = screenOptions.palette[i];
+            float rgb[3] = { (colour & 0xFF) / 255.0f, ((colour >> 8) & 0xFF) / 255.0f, ((colour >> 16) & 0xFF) / 255.0f };
+            ImGui::PushID(i);
+            if (ImGui::ColorEdit3("##colour", rgb, ImGuiColorEditFlags_NoInputs)) {
+                colour = 0xFF000000 | ((uint32_t)(rgb[2] * 255.0f + 0.5f) << 16) | ((uint32_t)(rgb[1] * 255.0f + 0.5f) << 8) | (uint32_t)(rgb[0] * 255.0f + 0.5f);
+            }
+            ImGui::PopID();
+            if (i % 8 != 7) ImGui::SameLine();
+        }
+        if (ImGui::Button("Default colours")) {
+            std::copy(std::begin(displayPalette), std::end(displayPalette), screenOptions.palette);
+        }
+        ImGui::TreePop();
+    }
     
+    ImGui::SeparatorText("Capture");
+
+    // Every frame goes to a PNG/raw sequence in a directory, or to an encoder command's stdin
+    const char* captureFormats[] = { "PNG sequence", "Raw RGBA sequence", "Pipe to command" };
+    if (capture.IsActive()) {
+        ImGui::BeginDisabled();
+    }
+    ImGui::Combo("##CaptureFormat", &captureFormat, captureFormats, IM_ARRAYSIZE(captureFormats));
+    ImGui::InputTextWithHint("##CaptureTarget", captureFormat == 2 ? "Command" : "Directory", captureTarget, sizeof(captureTarget));
+    if (capture.IsActive()) {
+        ImGui::EndDisabled();
+    }
+
+    if (ImGui::Button(capture.IsActive() ? "Stop Capture" : "Start Capture", ImVec2(-1, 0))) {
+        if (capture.IsActive()) {
+            capture.Stop();
+        } else {
+            // Native 128x64 frames in the display colours; encoders scale better than raw frames do
+            ScaleOptions options = screenOptions;
+            options.scale = 1;
+            std::string error;
+            if (!capture.Start((CaptureFormat)captureFormat, captureTarget, options, error)) {
+                std::cout << error << std::endl;
+            }
+        }
+    }
+    if (ImGui::Button("Screenshot", ImVec2(-1, 0))) {
+        SaveScreenshot(chip8);
+    }
+    if (capture.IsActive() || capture.Captured() > 0) {
+        ImGui::Text("Frames: %llu written, %llu dropped", (unsigned long long)capture.Written(), (unsigned long long)capture.Dropped());
+    }
+
     ImGui::SeparatorText("ROM Info");
     ImGui::TextWrapped("Current ROM:");
     if (!currentRomPath.empty()) {
@@ -461,50 +631,94 @@ void Graphics::RenderControls(Chip8& chip8)
     } else {
         ImGui::TextDisabled("No ROM loaded");
     }
+
+    // Reload automatically when the ROM file is rebuilt
+    ImGui::Text("On file change:");
+    int reloadMode = (int)hotReloadMode;
+    const char* reloadModes[] = { "Do nothing", "Restart", "Keep state", "Replay input" };
+    if (ImGui::Combo("##HotReload", &reloadMode, reloadModes, IM_ARRAYSIZE(reloadModes))) {
+        hotReloadMode = (HotReload)reloadMode;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Keep state: swap the new code into the running machine\nReplay input: restart and replay this run's keys and timer ticks");
+    }
     
     ImGui::SeparatorText("ROM Selection");
     
+    // Pick up whatever the background scan has found so far
+    romLibrary.Poll(romList);
+
+    if (romLibrary.IsScanning()) {
+        ImGui::TextDisabled("Scanning... %u / %u", romLibrary.Progress(), romLibrary.Total());
+    }
+
     // ROM list
-    if (availableRoms.empty()) {
-        ImGui::TextDisabled("No ROMs found");
-        if (ImGui::Button("Scan ROMs", ImVec2(-1, 0))) {
-            ScanForRoms();
+    if (romList.empty()) {
+        if (!romLibrary.IsScanning() && !romScanPending) {
+            ImGui::TextDisabled("No ROMs found");
+            if (ImGui::Button("Scan ROMs", ImVec2(-1, 0))) {
+                ScanForRoms();
+            }
         }
     } else {
-        ImGui::Text("Available ROMs:");
-        
-        // Create a combo box with all available ROMs
-        std::string previewValue = (selectedRomIndex >= 0 && selectedRomIndex < availableRoms.size()) 
-                                  ? availableRoms[selectedRomIndex] 
-                                  : "Select a ROM...";
-                                  
-        if (ImGui::BeginCombo("##romselect", previewValue.c_str())) {
-            for (int i = 0; i < availableRoms.size(); i++) {
-                bool isSelected = (selectedRomIndex == i);
-                
-                if (ImGui::Selectable(availableRoms[i].c_str(), isSelected)) {
-                    selectedRomIndex = i;
+        ImGui::SetNextItemWidth(-70.0f);
+        ImGui::InputTextWithHint("##romfilter", "Search...", romFilter, sizeof(romFilter));
+        ImGui::SameLine();
+        if (ImGui::Button("Rescan", ImVec2(-1, 0))) {
+            ScanForRoms();
+        }
+
+        // Case-insensitive substring match on the file name
+        std::string filter = romFilter;
+        std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
+
+        const RomEntry* selected = nullptr;
+        if (ImGui::BeginListBox("##romlist", ImVec2(-1, 8 * ImGui::GetTextLineHeightWithSpacing()))) {
+            for (const auto& rom : romList) {
+                std::string name = rom->name;
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                bool isSelected = rom->name == selectedRomName;
+                if (isSelected) {
+                    selected = rom.get();
+                }
+                if (!filter.empty() && name.find(filter) == std::string::npos) {
+                    continue;
+                }
+
+                // Entries the scan hasn't reached yet have no hash
+                std::string label = rom->name + (rom->hash ? std::string("  [") + VariantName(rom->variant) + "]" : "  ...");
+                if (ImGui::Selectable(label.c_str(), isSelected, ImGuiSelectableFlags_AllowDoubleClick)) {
+                    selectedRomName = rom->name;
+                    selected = rom.get();
+
+                    // Double-click loads straight away
+                    if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                        selectedRomPath = romsDirectory + "/" + rom->name;
+                        romLoadRequested = true;
+                    }
                 }
-                
                 if (isSelected) {
                     ImGui::SetItemDefaultFocus();
                 }
             }
-            ImGui::EndCombo();
+            ImGui::EndListBox();
         }
-        
+
+        if (selected && selected->hash) {
+            ImGui::Text("%llu bytes, %s", (unsigned long long)selected->size, VariantName(selected->variant));
+            RenderRomThumbnail(*selected);
+        }
+
         // Load ROM button
-        bool canLoad = selectedRomIndex >= 0 && selectedRomIndex < availableRoms.size();
+        bool canLoad = selected != nullptr;
         
         if (!canLoad) {
             ImGui::BeginDisabled();
         }
         
         if (ImGui::Button("Load Selected ROM", ImVec2(-1, 0))) {
-            if (selectedRomIndex >= 0 && selectedRomIndex < availableRoms.size()) {
-                selectedRomPath = romsDirectory + "/" + availableRoms[selectedRomIndex];
-                romLoadRequested = true;
-            }
+            selectedRomPath = romsDirectory + "/" + selected->name;
+            romLoadRequested = true;
         }
         
         if (!canLoad) {
@@ -517,6 +731,7 @@ void Graphics::RenderControls(Chip8& chip8)
 
 void Graphics::RenderKeyboard(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderKeyboard");
     ImGui::Begin("CHIP-8 - Keyboard", &showKeyboard, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     
     ImGui::SeparatorText("Keypad Layout");
@@ -552,7 +767,7 @@ void Graphics::RenderKeyboard(Chip8& chip8)
             if (col > 0) ImGui::SameLine();
             
             // Color the button if key is pressed
-            bool pressed = chip8.keypad[key];
+            bool pressed = chip8.IsKeyDown(key);
             if (pressed) {
                 ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 0.8f, 0.0f, 1.0f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
@@ -564,7 +779,7 @@ void Graphics::RenderKeyboard(Chip8& chip8)
             // Handle mouse press/release for this button
             if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
                 // Mouse pressed down on this button
-                chip8.keypad[key] = true;
+                keyEvents.Push(key, true);
                 mouseDownKey = key;
             }
             
@@ -576,7 +791,7 @@ void Graphics::RenderKeyboard(Chip8& chip8)
     
     // Release key when mouse is released anywhere
     if (mouseDownKey >= 0 && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
-        chip8.keypad[mouseDownKey] = false;
+        keyEvents.Push(mouseDownKey, false);
         mouseDownKey = -1;
     }
     
@@ -584,7 +799,7 @@ void Graphics::RenderKeyboard(Chip8& chip8)
     ImGui::SeparatorText("Active Keys");
     bool anyPressed = false;
     for (int i = 0; i < 16; i++) {
-        if (chip8.keypad[i]) {
+        if (chip8.IsKeyDown(i)) {
             if (anyPressed) ImGui::SameLine();
             ImGui::Text("0x%X", i);
             anyPressed = true;
@@ -599,6 +814,7 @@ void Graphics::RenderKeyboard(Chip8& chip8)
 
 void Graphics::RenderDisassembly(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderDisassembly");
     ImGui::Begin("CHIP-8 - CPU Disassembler", &showDisassembly, ImGuiWindowFlags_NoMove);
     
     static bool followPC = true;
@@ -608,19 +824,57 @@ void Graphics::RenderDisassembly(Chip8& chip8)
     
     ImGui::BeginChild("DisassemblyView", ImVec2(0, -1), true);
     
-    // Show more instructions around current PC for context
-    int startAddr = followPC ? std::max(0x200, (int)chip8.pc - 40) : 0x200;
-    int endAddr = std::min(4095, startAddr + 80); // Show ~40 instructions
+    // Show more instructions around current PC (or a breakpoint hit) for context
+    int centerAddr = disassemblyFocus >= 0 ? disassemblyFocus : chip8.pc;
+    int startAddr = (followPC || disassemblyFocus >= 0) ? std::max(0x200, centerAddr - 40) : 0x200;
+    int endAddr = std::min((int)MEMORY_SIZE - 1, startAddr + 80); // Show ~40 instructions
     
     // Use monospace font for better alignment
     ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]);
     
-    for (int addr = startAddr; addr < endAddr; addr += 2) {
-        if (addr >= 4095) break;
+    // Don't start in the middle of an instruction the analysis knows about
+    while (startAddr > 0x200 && analysis.Kind(startAddr) == ProgramAnalysis::OPERAND) {
+        startAddr--;
+    }
+    
+    int addr = startAddr;
+    while (addr < endAddr) {
+        if (addr >= (int)MEMORY_SIZE - 1) break;
+        
+        // Block labels from the control-flow analysis
+        std::string label = analysis.Label(addr);
+        if (!label.empty()) {
+            ImGui::TextDisabled("%s:", label.c_str());
+        }
+        
+        // Sprite/buffer bytes are shown as data, one byte per line with its bit pattern
+        ProgramAnalysis::ByteKind kind = analysis.Kind(addr);
+        if (kind == ProgramAnalysis::DATA && addr != chip8.pc) {
+            char bits[9];
+            for (int bit = 0; bit < 8; bit++) {
+                bits[bit] = (chip8.Read(addr) >> (7 - bit)) & 1 ? '#' : '.';
+            }
+            bits[8] = '\0';
+            ImGui::TextDisabled("   0x%03X | %02X    | %s    DB 0x%02X", addr, chip8.Read(addr), bits, chip8.Read(addr));
+            addr++;
+            continue;
+        }
         
-        uint16_t instruction = (chip8.memory[addr] << 8) | chip8.memory[addr + 1];
+        uint16_t instruction = (chip8.Read(addr) << 8) | chip8.Read(addr + 1);
         std::string decoded = DecodeInstruction(instruction);
         
+        // Bytes no code path reaches are dimmed: they may be data, or code only reached through BNNN
+        bool unreached = kind == ProgramAnalysis::UNKNOWN && addr != chip8.pc;
+        if (unreached) {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+        }
+        
+        // Breakpoints are shown in red; click a line to toggle one
+        bool hasBreakpoint = debugger.breakpoints.test(addr);
+        if (hasBreakpoint) {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
+        }
+        
         // Highlight current instruction with arrow and different background
         bool isCurrent = (addr == chip8.pc);
         if (isCurrent) {
@@ -628,26 +882,46 @@ void Graphics::RenderDisassembly(Chip8& chip8)
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.0f, 1.0f));
             ImGui::Text("-> 0x%03X | %02X %02X | %-12s  %s", 
                        addr, 
-                       chip8.memory[addr], 
-                       chip8.memory[addr + 1],
+                       chip8.Read(addr), 
+                       chip8.Read(addr + 1),
                        (std::to_string((instruction & 0xF000) >> 12) + std::to_string((instruction & 0x0F00) >> 8) + 
                         std::to_string((instruction & 0x00F0) >> 4) + std::to_string(instruction & 0x000F)).c_str(),
                        decoded.c_str());
             ImGui::PopStyleColor();
             
             // Auto-scroll to current instruction when following PC
-            if (followPC) {
+            if (followPC && disassemblyFocus < 0) {
                 ImGui::SetScrollHereY(0.5f);
             }
         } else {
             // Regular instruction display
-            ImGui::Text("   0x%03X | %02X %02X | %04X        %s", 
+            ImGui::Text("%s 0x%03X | %02X %02X | %04X        %s", 
+                       hasBreakpoint ? " *" : "  ",
                        addr, 
-                       chip8.memory[addr], 
-                       chip8.memory[addr + 1],
+                       chip8.Read(addr), 
+                       chip8.Read(addr + 1),
                        instruction,
                        decoded.c_str());
         }
+        
+        if (ImGui::IsItemClicked()) {
+            debugger.ToggleBreakpoint(addr);
+        }
+        
+        if (hasBreakpoint) {
+            ImGui::PopStyleColor();
+        }
+        if (unreached) {
+            ImGui::PopStyleColor();
+        }
+        
+        // Scroll to a breakpoint hit once, then go back to normal behaviour
+        if (addr == disassemblyFocus) {
+            ImGui::SetScrollHereY(0.5f);
+            disassemblyFocus = -1;
+        }
+        
+        addr += ProgramAnalysis::InstructionLength(instruction, chip8.variant);
     }
     
     ImGui::PopFont();
@@ -655,31 +929,49 @@ void Graphics::RenderDisassembly(Chip8& chip8)
     ImGui::End();
 }
 
+void Graphics::AnalyseProgram(const Chip8& chip8)
+{
+    analysis = ProgramAnalysis();
+    analysisMemory = chip8.memory;
+    analysisVariant = chip8.variant;
+    analysisPending = true;
+}
+
+void Graphics::RunAnalysis()
+{
+    TraceZone zone("Graphics::RunAnalysis");
+    analysisPending = false;
+    std::vector<uint8_t> memory(MEMORY_SIZE);
+    analysisMemory.Copy(0, memory.data(), memory.size());
+    analysis.Analyse(memory.data(), analysisVariant);
+
+    // Let the machine have its pages to itself again
+    analysisMemory = PagedMemory();
+    std::cout << "Analysis: " << analysis.Blocks().size() << " blocks, " << analysis.Subroutines().size() - 1
+              << " subroutines, " << analysis.LoopCount() << " loops" << std::endl;
+}
+
 void Graphics::RenderDisplay(Chip8& chip8)
 {
+    TraceZone zone("Graphics::RenderDisplay");
     ImGui::Begin("CHIP-8 - Display", &showDisplay, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     
-    // Convert CHIP-8 display to RGBA texture
-    uint32_t pixels[64 * 32];
-    for (int i = 0; i < 64 * 32; i++) {
-        // CHIP-8 uses 1-bit per pixel, convert to ABGR format (0xAABBGGRR)
-        pixels[i] = chip8.display[i] ? 0xFFFFFFFF : 0xFF000000; // White (ABGR) or Black (ABGR)
+    // The requested scale, or the largest that fits the window if that's smaller
+    ImVec2 windowSize = ImGui::GetContentRegionAvail();
+    int fit = (int)std::min(windowSize.x / DISPLAY_WIDTH, windowSize.y / DISPLAY_HEIGHT);
+    screenOptions.scale = (unsigned int)std::max(1, std::min(displayScale / 2, fit));
+    if (!UpdateDisplayTexture(chip8)) {
+        ImGui::End();
+        return;
     }
     
-    // Update the texture
-    SDL_UpdateTexture(displayTexture, nullptr, pixels, 64 * sizeof(uint32_t));
-    
-    // Set texture filtering to nearest neighbor for pixel-perfect rendering
-    SDL_SetTextureScaleMode(displayTexture, SDL_ScaleModeNearest);
-    
     // Get texture as ImGui texture ID
     ImTextureID textureID = (ImTextureID)(intptr_t)displayTexture;
     
-    // Fixed display size for consistent layout
-    ImVec2 displaySize(512, 256); // 8x scale of 64x32
+    // Drawn 1:1, both modes fill the same 2:1 texture
+    ImVec2 displaySize((float)screenOptions.Width(), (float)screenOptions.Height());
     
     // Center the display
-    ImVec2 windowSize = ImGui::GetContentRegionAvail();
     ImVec2 centerPos = ImVec2(
         (windowSize.x - displaySize.x) * 0.5f,
         (windowSize.y - displaySize.y) * 0.5f
@@ -688,16 +980,270 @@ void Graphics::RenderDisplay(Chip8& chip8)
     if (centerPos.x > 0) ImGui::SetCursorPosX(ImGui::GetCursorPosX() + centerPos.x);
     if (centerPos.y > 0) ImGui::SetCursorPosY(ImGui::GetCursorPosY() + centerPos.y);
     
-    // Render the display with nearest neighbor filtering for pixel-perfect scaling
-    ImGui::Image(textureID, displaySize, ImVec2(0, 0), ImVec2(1, 1), ImVec4(1, 1, 1, 1), ImVec4(0, 0, 0, 0));
+    ImGui::Image(textureID, displaySize);
+    
+    ImGui::End();
+}
+
+bool Graphics::UpdateDisplayTexture(const Chip8& chip8)
+{
+    TraceZone zone("Graphics::UpdateDisplayTexture");
+    // (Re)create the streaming texture when the scale changes
+    if (!displayTexture || displayTextureScale != screenOptions.scale) {
+        if (displayTexture) {
+            SDL_DestroyTexture(displayTexture);
+        }
+        displayTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, screenOptions.Width(), screenOptions.Height());
+        if (!displayTexture) {
+            std::cout << "Failed to create display texture: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_SetTextureScaleMode(displayTexture, SDL_ScaleModeNearest);
+        displayTextureScale = screenOptions.scale;
+    }
+
+    // Scale straight into the texture's memory (ABGR words, see displayPalette)
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(displayTexture, nullptr, &pixels, &pitch) != 0) {
+        return false;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    ScaleDisplay(chip8.display, chip8.hires, screenOptions, (uint32_t*)pixels, pitch);
+    scalerMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+    SDL_UnlockTexture(displayTexture);
+    Metrics::Add(metrics.textureUploads, 1);
+    return true;
+}
+
+void Graphics::SaveScreenshot(const Chip8& chip8)
+{
+    // Next free screenshot_NNN.png in the working directory, at the size on screen
+    std::string path;
+    for (int i = 0; path.empty() || std::filesystem::exists(path); i++) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "screenshot_%03d.png", i);
+        path = name;
+    }
+    if (FrameCapture::WritePng(path, chip8.display, chip8.hires, screenOptions)) {
+        std::cout << "Saved " << path << std::endl;
+    } else {
+        std::cout << "Failed to write screenshot: " << path << std::endl;
+    }
+}
+
+void Graphics::RenderBreakpoints(Chip8& chip8)
+{
+    TraceZone zone("Graphics::RenderBreakpoints");
+    ImGui::Begin("CHIP-8 - Breakpoints", &showBreakpoints);
+    
+    // Last hit
+    const Debugger::Hit& hit = debugger.LastHit();
+    if (hit.type != Debugger::HitType::None) {
+        const char* hitNames[] = { "None", "Breakpoint", "Condition", "Read watch", "Write watch" };
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+        ImGui::Text("Hit: %s at PC 0x%03X (0x%03X)", hitNames[(int)hit.type], hit.pc, hit.address);
+        ImGui::PopStyleColor();
+    }
+    
+    // PC breakpoints
+    ImGui::SeparatorText("PC Breakpoints");
+    static int bpAddress = 0x200;
+    ImGui::SetNextItemWidth(120);
+    ImGui::InputInt("##bpaddr", &bpAddress, 2, 16, ImGuiInputTextFlags_CharsHexadecimal);
+    bpAddress = std::clamp(bpAddress, 0, (int)MEMORY_SIZE - 1);
+    ImGui::SameLine();
+    if (ImGui::Button("Add##bp")) {
+        debugger.breakpoints.set(bpAddress);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("At PC")) {
+        debugger.breakpoints.set(chip8.pc);
+    }
+    
+    for (int addr = 0; addr < (int)MEMORY_SIZE; addr++) {
+        if (!debugger.breakpoints.test(addr)) continue;
+        ImGui::PushID(addr);
+        ImGui::Text("0x%03X", addr);
+        ImGui::SameLine(80);
+        if (ImGui::SmallButton("Remove")) {
+            debugger.breakpoints.reset(addr);
+        }
+        ImGui::PopID();
+    }
+    
+    // Conditional breakpoints on register values
+    ImGui::SeparatorText("Register Conditions");
+    static int condReg = 0;
+    static int condCmp = 0;
+    static int condValue = 0;
+    const char* regNames[] = { "V0", "V1", "V2", "V3", "V4", "V5", "V6", "V7", "V8", "V9", "VA", "VB", "VC", "VD", "VE", "VF" };
+    const char* cmpNames[] = { "==", "!=", "<", ">" };
+    ImGui::SetNextItemWidth(50);
+    ImGui::Combo("##condreg", &condReg, regNames, 16);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(50);
+    ImGui::Combo("##condcmp", &condCmp, cmpNames, 4);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("##condval", &condValue, 1, 16, ImGuiInputTextFlags_CharsHexadecimal);
+    condValue = std::clamp(condValue, 0, 255);
+    ImGui::SameLine();
+    if (ImGui::Button("Add##cond")) {
+        debugger.AddCondition((uint8_t)condReg, (Debugger::Compare)condCmp, (uint8_t)condValue);
+    }
+    
+    for (size_t i = 0; i < debugger.conditions.size(); i++) {
+        Debugger::Condition& c = debugger.conditions[i];
+        ImGui::PushID((int)i);
+        ImGui::Checkbox("##enabled", &c.enabled);
+        ImGui::SameLine();
+        ImGui::Text("V%X %s 0x%02X", c.reg, cmpNames[(int)c.cmp], c.value);
+        ImGui::SameLine(160);
+        bool remove = ImGui::SmallButton("Remove");
+        ImGui::PopID();
+        if (remove) {
+            debugger.conditions.erase(debugger.conditions.begin() + i);
+            break;
+        }
+    }
+    
+    // Memory watchpoints
+    ImGui::SeparatorText("Memory Watchpoints");
+    static int watchStart = 0x200;
+    static int watchEnd = 0x200;
+    static bool watchRead = false;
+    static bool watchWrite = true;
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("##watchstart", &watchStart, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::SameLine();
+    ImGui::Text("-");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80);
+    ImGui::InputInt("##watchend", &watchEnd, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+    watchStart = std::clamp(watchStart, 0, (int)MEMORY_SIZE - 1);
+    watchEnd = std::clamp(watchEnd, watchStart, (int)MEMORY_SIZE - 1);
+    ImGui::Checkbox("Read", &watchRead);
+    ImGui::SameLine();
+    ImGui::Checkbox("Write", &watchWrite);
+    ImGui::SameLine();
+    if (ImGui::Button("Watch")) {
+        debugger.SetWatch((uint16_t)watchStart, (uint16_t)watchEnd, watchRead, watchWrite);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Unwatch")) {
+        debugger.ClearWatch((uint16_t)watchStart, (uint16_t)watchEnd);
+    }
+    
+    // List watched ranges by collapsing runs of set bits
+    for (int addr = 0; addr < (int)MEMORY_SIZE; addr++) {
+        bool r = debugger.readWatch.test(addr);
+        bool w = debugger.writeWatch.test(addr);
+        if (!r && !w) continue;
+        
+        int end = addr;
+        while (end + 1 < (int)MEMORY_SIZE && debugger.readWatch.test(end + 1) == r && debugger.writeWatch.test(end + 1) == w) {
+            end++;
+        }
+        ImGui::Text("0x%03X-0x%03X  %s%s", addr, end, r ? "R" : "", w ? "W" : "");
+        addr = end;
+    }
+    
+    ImGui::Separator();
+    if (ImGui::Button("Clear All", ImVec2(-1, 0))) {
+        debugger.ClearAll();
+    }
     
     ImGui::End();
 }
 
+void Graphics::RenderPerformance()
+{
+    TraceZone zone("Graphics::RenderPerformance");
+    ImGui::Begin("CHIP-8 - Performance", &showPerformance);
+
+    // Rates over the last half second
+    MetricsSnapshot now = Snapshot(metrics);
+    if (now.time - perfLatest.time >= std::chrono::milliseconds(500)) {
+        perfPrevious = perfLatest;
+        perfLatest = now;
+    }
+    const MetricsSnapshot& a = perfLatest;
+    const MetricsSnapshot& b = perfPrevious;
+
+    ImGui::Text("Instructions/s:   %.0f", a.InstructionsPerSecond(b));
+    ImGui::Text("Frames emulated:  %.1f/s", a.EmulatedFps(b));
+    ImGui::Text("Frames presented: %.1f/s", a.PresentedFps(b));
+    ImGui::Text("UI render:        %.2f ms/frame", a.UiRenderMillis(b));
+    ImGui::Text("Texture uploads:  %.1f/s", a.UploadsPerSecond(b));
+    ImGui::Text("Display scaler:   %s, %.1f us at %ux%u", ScalerKernel(), scalerMicros, screenOptions.Width(), screenOptions.Height());
+    ImGui::Text("Timer drift:      %+.2f ms", now.timerDriftMicros / 1000.0);
+    ImGui::Text("Audio queue:      %u ticks", now.audioQueued);
+    ImGui::Text("Capture queue:    %u frames (%llu dropped)", now.captureQueued, (unsigned long long)now.framesDropped);
+    ImGui::Text("Input latency:    %.1f ms (last %.1f ms)", a.InputLatencyMillis(b), now.lastInputLatencyMicros / 1000.0);
+    ImGui::Text("Start-up:         %.1f ms to first frame, %.1f ms on screen", now.firstFrameMicros / 1000.0, now.firstPresentMicros / 1000.0);
+
+    // Frame phase timeline: each thread keeps its last few seconds of zones, saved on demand
+    ImGui::SeparatorText("Timeline");
+    bool tracing = Trace::IsEnabled();
+    if (ImGui::Checkbox("Record", &tracing)) {
+        Trace::SetEnabled(tracing);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace")) {
+        std::string error;
+        traceStatus = Trace::Export(tracePath, error) ? "Saved " + tracePath : error;
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%llu zones", (unsigned long long)Trace::Recorded());
+    if (!traceStatus.empty()) {
+        ImGui::TextWrapped("%s", traceStatus.c_str());
+    }
+
+    // Frame time distribution since start
+    ImGui::SeparatorText("Frame time");
+    float counts[FRAME_TIME_BUCKET_COUNT];
+    for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT; i++) {
+        counts[i] = (float)now.frameTimeBuckets[i];
+    }
+    ImGui::PlotHistogram("##frametime", counts, FRAME_TIME_BUCKET_COUNT, 0, NULL, 0.0f, FLT_MAX, ImVec2(-1, 80));
+    uint64_t frames = now.FrameCount();
+    ImGui::Text("<=%gms ... >%gms, mean %.2f ms over %llu frames", FRAME_TIME_BUCKETS_MS[0], FRAME_TIME_BUCKETS_MS[FRAME_TIME_BUCKET_COUNT - 2],
+                frames ? now.frameTimeMicros / 1000.0 / frames : 0.0, (unsigned long long)frames);
+
+    for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT; i++) {
+        if (i < FRAME_TIME_BUCKET_COUNT - 1) {
+            ImGui::Text("%6g ms  %5.1f%%", FRAME_TIME_BUCKETS_MS[i], frames ? 100.0 * now.frameTimeBuckets[i] / frames : 0.0);
+        } else {
+            ImGui::Text("  slower  %5.1f%%", frames ? 100.0 * now.frameTimeBuckets[i] / frames : 0.0);
+        }
+    }
+
+    ImGui::End();
+}
+
+void Graphics::OnBreak()
+{
+    const Debugger::Hit& hit = debugger.LastHit();
+    
+    // A break needs the debugger on screen
+    if (playerMode) {
+        SetPlayerMode(false);
+    }
+
+    isPaused = true;
+    isStep = false;
+    
+    // Point the disassembly at the instruction and the memory view at what it touched
+    disassemblyFocus = hit.pc;
+    memoryFollowPC = false;
+    memoryStart = std::min((hit.address / 16) * 16, (int)MEMORY_SIZE - 256);
+    showBreakpoints = true;
+}
+
 std::string Graphics::DecodeInstruction(uint16_t instruction)
 {
-    Chip8 tempChip8;
-    return tempChip8.DecodeAndExecute(instruction);
+    return Chip8::Disassemble(instruction);
 }
 
 void Graphics::AddToHistory(uint16_t address, uint16_t instruction)
@@ -717,37 +1263,41 @@ void Graphics::AddToHistory(uint16_t address, uint16_t instruction)
 
 void Graphics::ScanForRoms()
 {
-    availableRoms.clear();
-    
-    if (romsDirectory.empty()) {
-        return;
-    }
-    
-    try {
-        for (const auto& entry : std::filesystem::directory_iterator(romsDirectory)) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
-                // Skip hidden files and system files
-                if (filename[0] != '.' && filename != "DS_Store") {
-                    availableRoms.push_back(filename);
-                }
+    // Runs in the background; RenderControls picks up the results as they arrive
+    romLibrary.Scan(romsDirectory);
+}
+
+void Graphics::RenderRomThumbnail(const RomEntry& rom)
+{
+    // Draw the thumbnail's lit pixels straight into the window, 2 screen pixels per lo-res pixel
+    unsigned int width = rom.thumbnailHires ? DISPLAY_WIDTH : LORES_WIDTH;
+    unsigned int height = rom.thumbnailHires ? DISPLAY_HEIGHT : LORES_HEIGHT;
+    float pixel = rom.thumbnailHires ? 1.0f : 2.0f;
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + width * pixel, origin.y + height * pixel), IM_COL32(0, 0, 0, 255));
+
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            if ((rom.thumbnail[y][x >> 6] >> (63 - (x & 63))) & 1) {
+                ImVec2 p(origin.x + x * pixel, origin.y + y * pixel);
+                drawList->AddRectFilled(p, ImVec2(p.x + pixel, p.y + pixel), IM_COL32(255, 255, 255, 255));
             }
         }
-    } catch (const std::filesystem::filesystem_error& ex) {
-        std::cout << "Error scanning ROMs directory: " << ex.what() << std::endl;
     }
+    ImGui::Dummy(ImVec2(width * pixel, height * pixel));
 }
 
-void Graphics::RenderFrame(Chip8& chip8)
+void Graphics::RenderDebugger(Chip8& chip8)
 {
-    // Set background color to black and clear the entire screen
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-    
     // Initialize ImGui for a new frame of UI rendering
-    ImGui_ImplSDLRenderer2_NewFrame();
-    ImGui_ImplSDL2_NewFrame();
-    ImGui::NewFrame();
+    {
+        TraceZone zone("ImGui::NewFrame");
+        ImGui_ImplSDLRenderer2_NewFrame();
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+    }
 
     // Create the top menu bar with Debug and View menus
     if (ImGui::BeginMainMenuBar()) {
@@ -759,6 +1309,8 @@ void Graphics::RenderFrame(Chip8& chip8)
             ImGui::MenuItem("Display", NULL, &showDisplay);
             ImGui::MenuItem("Controls", NULL, &showControls);
             ImGui::MenuItem("Keyboard", NULL, &showKeyboard);
+            ImGui::MenuItem("Breakpoints", NULL, &showBreakpoints);
+            ImGui::MenuItem("Performance", NULL, &showPerformance);
             ImGui::Separator();
             ImGui::EndMenu();
         }
@@ -766,6 +1318,9 @@ void Graphics::RenderFrame(Chip8& chip8)
             if (ImGui::MenuItem("Reset Layout")) {
                 SetupWindowLayout();
             }
+            if (ImGui::MenuItem("Player Mode", "F11")) {
+                SetPlayerMode(true);
+            }
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
@@ -775,11 +1330,99 @@ void Graphics::RenderFrame(Chip8& chip8)
     RenderOrganizedLayout(chip8);
     
     // Convert ImGui draw commands to actual graphics and render them
-    ImGui::Render(); // Finalize ImGui draw data
-    ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer); // Draw to SDL renderer
+    {
+        TraceZone zone("ImGui::Render");
+        ImGui::Render(); // Finalize ImGui draw data
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), renderer); // Draw to SDL renderer
+    }
+}
+
+void Graphics::RenderPlayer(const Chip8& chip8)
+{
+    TraceZone zone("Graphics::RenderPlayer");
+
+    // Upload the display at one texture pixel per hi-res pixel and let the renderer scale it up:
+    // a 32KB upload whatever the window size. The copy is the largest whole multiple that fits,
+    // so every CHIP-8 pixel is the same size on screen.
+    screenOptions.scale = 1;
+    if (!UpdateDisplayTexture(chip8)) {
+        return;
+    }
+
+    int outputWidth, outputHeight;
+    SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+    int fit = std::max(1, std::min(outputWidth / (int)DISPLAY_WIDTH, outputHeight / (int)DISPLAY_HEIGHT));
+    SDL_Rect target = { (outputWidth - (int)DISPLAY_WIDTH * fit) / 2, (outputHeight - (int)DISPLAY_HEIGHT * fit) / 2, (int)DISPLAY_WIDTH * fit, (int)DISPLAY_HEIGHT * fit };
+    SDL_RenderCopy(renderer, displayTexture, nullptr, &target);
+}
+
+void Graphics::SetPlayerMode(bool enabled)
+{
+    playerMode = enabled;
+    if (!window) {
+        return; // Init applies it
+    }
+
+    // Fullscreen at the desktop resolution (no mode switch), and present in step with the display
+    SDL_SetWindowFullscreen(window, playerMode ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
+    SDL_RenderSetVSync(renderer, playerMode ? 1 : 0);
+}
+
+void Graphics::RenderFrame(Chip8& chip8)
+{
+    TraceZone frameZone("Graphics::RenderFrame");
+    auto renderStart = std::chrono::high_resolution_clock::now();
+
+    // Set background color to black and clear the entire screen
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    
+    // The debugger UI, or in player mode just the display
+    if (playerMode) {
+        RenderPlayer(chip8);
+    } else {
+        RenderDebugger(chip8);
+    }
     
+    // Time the UI up to here; presenting may wait for vsync
+    auto renderEnd = std::chrono::high_resolution_clock::now();
+    Metrics::Add(metrics.uiRenderMicros, std::chrono::duration_cast<std::chrono::microseconds>(renderEnd - renderStart).count());
+
     // Display the completed frame on screen
-    SDL_RenderPresent(renderer);
+    {
+        TraceZone zone("SDL_RenderPresent");
+        SDL_RenderPresent(renderer);
+    }
+
+    if (metrics.framesPresented.load(std::memory_order_relaxed) > 0) {
+        metrics.RecordFrameTime(renderEnd - lastPresentTime);
+    }
+    lastPresentTime = renderEnd;
+    Metrics::Add(metrics.framesPresented, 1);
+
+    // Work that can wait until a frame is on screen, and is only done for the windows that need it
+    if (romScanPending && showControls && !playerMode) {
+        romScanPending = false;
+        ScanForRoms();
+    }
+    if (analysisPending && showDisassembly && !playerMode) {
+        RunAnalysis();
+    }
+
+    // Input latency: the first presented frame that differs from the display when the key went in.
+    // A press that changes nothing on screen within a second isn't counted.
+    if (latencyPending) {
+        uint64_t hash = HashRom(reinterpret_cast<const uint8_t*>(chip8.display), sizeof(chip8.display));
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(KeyEventQueue::Clock::now() - latencyStart);
+        if (hash != latencyDisplayHash) {
+            Metrics::Add(metrics.inputLatencyMicros, latency.count());
+            Metrics::Add(metrics.inputLatencySamples, 1);
+            metrics.lastInputLatencyMicros.store((uint32_t)latency.count(), std::memory_order_relaxed);
+            latencyPending = false;
+        } else if (latency > std::chrono::seconds(1)) {
+            latencyPending = false;
+        }
+    }
 }
 
 void Graphics::Shutdown()
@@ -4,15 +4,36 @@
 #include <vector>
 #include <filesystem>
 #include "chip8.h"
+#include "debugger.h"
+#include "rom_library.h"
+#include "capture.h"
+#include "analysis.h"
+#include "metrics.h"
+#include "key_events.h"
+#include "scaler.h"
 #include "imgui.h"
 
 class Graphics 
 {
+public:
+    // What to do when the running ROM's file changes on disk
+    enum class HotReload { Off, Restart, KeepState, Replay };
+
+private:
     // SDL objects
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* displayTexture;
 
+    // Display: the requested size of a lo-res pixel (the `scale` argument / slider), and
+    // the scale and palette actually drawn with. The texture is exactly the size it's shown at.
+    int displayScale;
+    ScaleOptions screenOptions;
+    unsigned int displayTextureScale;
+    double scalerMicros;
+    bool UpdateDisplayTexture(const Chip8& chip8);
+    void SaveScreenshot(const Chip8& chip8);
+
     // Menu toggles for various windows
     bool showCPUState;
     bool showRegisters;
@@ -21,20 +42,68 @@ class Graphics
     bool showDisplay;
     bool showControls;
     bool showKeyboard;
+    bool showBreakpoints;
+    bool showPerformance;
+
+    // Player mode: just the display, fullscreen with vsync, and no ImGui frame at all
+    bool playerMode;
 
     // Control state
     bool isReset;
     bool isPaused;
     bool isStep;
     std::string currentRomPath;
+    HotReload hotReloadMode;
+    bool vipTiming;
+
+    // Breakpoints/watchpoints, and where the memory and disassembly views are looking
+    Debugger debugger;
+    int memoryStart;
+    bool memoryFollowPC;
+    int disassemblyFocus; // address to scroll the disassembly to once, -1 for none
+    ProgramAnalysis analysis; // code/data map and labels for the disassembly
+    bool analysisPending;     // a program was loaded; analyse it once a frame is on screen
+    PagedMemory analysisMemory; // the program as loaded (shares its pages), until it's analysed
+    Variant analysisVariant;
     
-    // ROM selection
+    // ROM selection. The library scans on a background thread; romList is the UI's copy of its results.
+    // The first scan waits until a frame is on screen and the selector is shown.
+    bool romScanPending;
     bool romLoadRequested;
     std::string selectedRomPath;
-    std::vector<std::string> availableRoms;
     std::string romsDirectory;
-    int selectedRomIndex;
-    void ScanForRoms(); 
+    RomLibrary romLibrary;
+    std::vector<std::shared_ptr<const RomEntry>> romList;
+    std::string selectedRomName;
+    char romFilter[64];
+    void ScanForRoms();
+    void RunAnalysis();
+    void RenderRomThumbnail(const RomEntry& rom);
+
+    // Frame capture (Controls window), fed by the main loop once per frame
+    FrameCapture capture;
+    int captureFormat;
+    char captureTarget[256];
+
+    // Keyboard input: physical key (scancode) -> keypad key, or -1. Key changes are
+    // queued with their SDL timestamps for the main loop to apply mid-batch.
+    int8_t scancodeKeys[SDL_NUM_SCANCODES];
+    KeyEventQueue keyEvents;
+
+    // Input latency: the last key press applied, waiting for a presented frame that shows a change
+    bool latencyPending;
+    KeyEventQueue::Clock::time_point latencyStart;
+    uint64_t latencyDisplayHash;
+
+    // Counters for the performance panel and the metrics exporter. The panel
+    // compares snapshots half a second apart rather than every frame.
+    Metrics metrics;
+    MetricsSnapshot perfPrevious, perfLatest;
+    std::chrono::high_resolution_clock::time_point lastPresentTime;
+
+    // Where the Performance window's Save trace writes the timeline, and how that went
+    std::string tracePath;
+    std::string traceStatus;
     
     // Instruction history for debugging
     struct InstructionHistory {
@@ -58,6 +127,8 @@ class Graphics
 
     // Private helper methods for rendering and layout
     void SetupWindowLayout();
+    void RenderDebugger(Chip8& chip8);
+    void RenderPlayer(const Chip8& chip8);
     void RenderOrganizedLayout(Chip8& chip8);
     void RenderCPUState(Chip8& chip8);
     void RenderRegisters(Chip8& chip8);
@@ -66,6 +137,8 @@ class Graphics
     void RenderKeyboard(Chip8& chip8);
     void RenderDisassembly(Chip8& chip8);
     void RenderDisplay(Chip8& chip8);  
+    void RenderBreakpoints(Chip8& chip8);
+    void RenderPerformance();
       
 public:
     Graphics();
@@ -91,11 +164,39 @@ public:
     bool ShouldReset() const { return isReset; }
     std::string GetSelectedRomPath() const { return selectedRomPath; }
     bool IsRomLoadRequested() const { return romLoadRequested; }
+    Debugger& GetDebugger() { return debugger; }
+    HotReload GetHotReloadMode() const { return hotReloadMode; }
+    bool UseVipTiming() const { return vipTiming; }
+    FrameCapture& GetCapture() { return capture; }
+    Metrics& GetMetrics() { return metrics; }
+    KeyEventQueue& GetKeyEvents() { return keyEvents; }
+
+    // Replace the default key bindings from a file of "<keypad key> <SDL scancode name>..." lines
+    bool LoadKeyMap(const std::string& path, std::string& error);
+
+    // Screen pixels per lo-res pixel (hi-res pixels are half that), and the display colours as RRGGBB,...
+    void SetDisplayScale(int scale) { displayScale = std::max(2, scale & ~1); }
+    bool SetPalette(const std::string& colours, std::string& error) { return ParsePalette(colours, screenOptions.palette, error); }
+
+    // The main loop applied a queued key change to the machine (for the latency measurement)
+    void KeyApplied(const KeyEventQueue::Event& event, const Chip8& chip8);
 
     // Setters for control state in main loop
     void ResetHandled() { isReset = false; }
     void StepHandled() { isStep = false; }
     void RomLoadHandled() { romLoadRequested = false; }
     void SetRomPath(const std::string& path) { currentRomPath = path; }
-    void SetRomsDirectory(const std::string& dir) { romsDirectory = dir; ScanForRoms(); } 
+    void SetVipTiming(bool enabled) { vipTiming = enabled; }
+    void SetPlayerMode(bool enabled);
+    bool IsPlayerMode() const { return playerMode; }
+    void SetTracePath(const std::string& path) { tracePath = path; }
+    void SetRomsDirectory(const std::string& dir) { romsDirectory = dir; romScanPending = true; }
+
+    // Recover the loaded program's control flow for the disassembly view (call after loading a ROM).
+    // Memory is snapshotted now, before the program runs; only the analysis itself waits until
+    // after the next frame is presented, or until the disassembly is shown.
+    void AnalyseProgram(const Chip8& chip8);
+
+    // Pause and point the memory/disassembly views at the debugger's last hit
+    void OnBreak();
 };
\ No newline at end of file
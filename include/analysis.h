@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "const.h"
+#include "quirks.h"
+
+// Static control-flow analysis of the program in memory.
+// Follows every path from the entry point (both sides of skips, jumps, calls)
+// to find which bytes are instructions, splits them into basic blocks and
+// links those into a control-flow graph, then marks subroutines (CALL
+// targets) and loops (targets of back edges). Bytes that instructions read as
+// sprites or load/store buffers are marked as data. Indirect jumps (BNNN) and
+// self-modifying code can't be followed statically; what they reach stays unknown.
+class ProgramAnalysis
+{
+public:
+	enum ByteKind : uint8_t
+	{
+		UNKNOWN, // never reached or referenced
+		CODE,    // first byte of an instruction
+		OPERAND, // rest of an instruction (second byte, or F000's address word)
+		DATA     // sprite / buffer bytes the code refers to through I
+	};
+
+	struct Block
+	{
+		uint16_t start = 0;
+		uint16_t end = 0;                  // one past the last byte
+		std::vector<uint16_t> successors;  // where control can go next
+		std::vector<uint16_t> calls;       // subroutines called from this block
+		uint16_t subroutine = 0;           // entry of the routine the block belongs to
+		bool returns = false;              // ends in RET
+		bool indirect = false;             // ends in BNNN: successors unknown
+		bool loopHeader = false;           // target of a back edge
+	};
+
+	// Analyse `memory` (MEMORY_SIZE bytes) starting from `entry`
+	void Analyse(const uint8_t* memory, Variant variant, uint16_t entry = PC_START_ADDRESS);
+
+	ByteKind Kind(uint16_t address) const { return kinds.empty() ? UNKNOWN : static_cast<ByteKind>(kinds[address % MEMORY_SIZE]); }
+
+	// The block starting at `address`, or nullptr
+	const Block* BlockAt(uint16_t address) const;
+
+	const std::map<uint16_t, Block>& Blocks() const { return blocks; }
+	// CALL targets, plus the entry point
+	const std::set<uint16_t>& Subroutines() const { return subroutines; }
+	unsigned int LoopCount() const { return loops; }
+
+	// "start", "sub_2A0", "loop_2B4" or "L_2C0" for a block start, "" anywhere else
+	std::string Label(uint16_t address) const;
+
+	// Size of the instruction at `address` (4 for XO-CHIP's F000 NNNN)
+	static unsigned int InstructionLength(const uint8_t* memory, uint16_t address, Variant variant);
+	static unsigned int InstructionLength(uint16_t opcode, Variant variant);
+
+private:
+	std::vector<uint8_t> kinds;
+	std::map<uint16_t, Block> blocks;
+	std::set<uint16_t> subroutines;
+	unsigned int loops = 0;
+	uint16_t entryPoint = PC_START_ADDRESS;
+};
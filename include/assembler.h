@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CHIP-8 / SUPER-CHIP / XO-CHIP assembler.
+// Accepts the mnemonics Chip8::Disassemble prints (so disassembly can be fed
+// back in; "(decimal)" annotations are ignored) plus:
+//   label:            define a label at the current address
+//   DB 0x.., ..       raw bytes (sprites, data)
+//   DW 0x.., ..       raw big-endian words
+//   ORG 0x...         pad with zeros up to an address
+//   LD I, LONG addr   XO-CHIP F000 NNNN (LONG is a separate word: LD I, LONGX is label LONGX)
+//   UNK 0x....        a raw instruction word
+// Operands are numbers (0x hex, 0b binary, decimal, negative bytes allowed),
+// labels, or label +/- offsets. Comments start with ';'. Case-insensitive.
+class Assembler
+{
+public:
+	// Address the first byte is assembled to (where the ROM is loaded)
+	uint16_t origin = 0x200;
+
+	// Assemble `source` into `rom`. On failure returns false with "line N: message" in `error`.
+	bool Assemble(const std::string& source, std::vector<uint8_t>& rom, std::string& error);
+};
+
+// Source for a synthetic benchmark/test workload. `kind` is one of:
+//   alu   `size` arithmetic/logic instructions in a loop
+//   draw  `size` sprite draws per loop, moving across the screen
+//   call  subroutine calls nested `size` deep (max 15), in a loop
+//   smc   self-modifying: rewrites the immediate of an instruction `size` times per loop
+// Each loops forever, so run it for a fixed number of frames. Returns false if `kind` is unknown.
+bool GenerateWorkload(const std::string& kind, unsigned int size, std::string& source);
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "const.h"
+#include "scaler.h"
+#include "spsc_ring.h"
+
+class Chip8;
+
+// Image sequence or stream to write captured frames to
+enum class CaptureFormat : uint8_t
+{
+	Png,  // numbered RGBA PNG files in a directory
+	Raw,  // numbered files of raw RGBA pixels in a directory
+	Pipe  // raw RGBA frames to the stdin of a command (e.g. an encoder)
+};
+
+// Records the display every frame without slowing emulation down.
+// Submit() only copies the bit-packed display into a buffer from a fixed pool
+// and queues it; a background thread turns queued frames into pixels and
+// writes them out. Every frame is kept unless the encoder falls a whole pool
+// behind, in which case the frame is dropped and counted.
+// Frames are 128x64 times the scale; lo-res frames are pixel-doubled so a stream has one size.
+class FrameCapture
+{
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	// Start capturing to `target`: a directory for Png/Raw, a shell command for Pipe,
+	// with frames scaled and coloured by `options`.
+	// Returns false and sets `error` if the target can't be opened.
+	bool Start(CaptureFormat format, const std::string& target, const ScaleOptions& options, std::string& error);
+
+	// Write out everything still queued and stop
+	void Stop();
+
+	// Queue the current display. With `wait`, block for a free buffer instead of
+	// dropping (for headless runs, which would otherwise outrun the encoder).
+	void Submit(const Chip8& chip8, bool wait = false);
+
+	bool IsActive() const { return active; }
+	uint64_t Captured() const { return captured.load(std::memory_order_relaxed); }
+	uint64_t Written() const { return written.load(std::memory_order_relaxed); }
+	uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+	size_t Queued() const { return queued.Size(); }
+
+	// Write one frame as a PNG file (used for single screenshots too)
+	static bool WritePng(const std::string& path, const uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS], bool hires, const ScaleOptions& options);
+	static bool WritePng(const std::string& path, const uint32_t* pixels, unsigned int width, unsigned int height);
+
+	static const unsigned int POOL_SIZE = 128;
+
+private:
+	struct Frame
+	{
+		uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS];
+		bool hires;
+		uint64_t number;
+	};
+
+	void Worker();
+	bool Encode(const Frame& frame);
+
+	// Buffers cycle from `freeFrames` (encoder -> emulator) to `queued` (emulator -> encoder)
+	std::unique_ptr<Frame[]> pool;
+	SpscRing<Frame*, POOL_SIZE> freeFrames;
+	SpscRing<Frame*, POOL_SIZE> queued;
+
+	// Only used to sleep the encoder while the queue is empty, and a producer waiting for a buffer
+	std::mutex mutex;
+	std::condition_variable wake;
+
+	std::thread thread;
+	std::atomic<bool> stopping{false};
+	bool active = false;
+	CaptureFormat format = CaptureFormat::Png;
+	std::string target;
+	FILE* pipe = nullptr;
+	ScaleOptions options;
+	std::vector<uint32_t> pixels; // the encoder's scaled frame
+
+	std::atomic<uint64_t> captured{0};
+	std::atomic<uint64_t> written{0};
+	std::atomic<uint64_t> dropped{0};
+};
@@ -1,45 +1,67 @@
 #pragma once
 #include <cstdint>
-#include <fstream>
 #include <string>
 #include "const.h"
+#include "paged_memory.h"
+#include "quirks.h"
+#include "random.h"
+
+class Debugger;
+struct RomImage;
 
 class Chip8
 {
 public:
 	// Attributes ******************************************************************
-	// Memory map (4096 bytes):
-	// 0x000-0x1FF: Reserved. Store fontset somewhere in here (050–09F)
-	// 0x200-0xFFF: Instructions from the ROM 
-	uint8_t memory[MEMORY_SIZE]{};
-
-	// Monochrome display (black & white), 64x32 pixels
-	// Each pixel is either on or off
-	// (originally updates at 60Hz, for simplicity we'll redraw it when executing instructions that change the display)
-	uint32_t display[DISPLAY_SIZE]{};
+	// Chip8 is plain data apart from `memory`, whose pages are shared copy-on-write:
+	// copying a machine (snapshot, reset, another instance) copies a few KB of
+	// registers, display and page table and shares the 64KB address space.
+	// Keep everything else plain; no pointers into the machine itself.
 
+	// Hot CPU state, in one cache line: everything fetch/decode/execute touches on most instructions.
 	// Program counter, current instruction address
-	uint16_t pc;
+	alignas(64) uint16_t pc = PC_START_ADDRESS;
 
 	// index register, point at location in memory
-	uint16_t index;
+	uint16_t index = 0;
 
 	// Stack and stack pointer
 	uint16_t stack[STACK_SIZE]{};
-	uint8_t sp;
+	uint8_t sp = 0;
+
+	// 16 registers, from V0 to VF. VF (registers[0xF]) is also used as a flag by some instructions
+	uint8_t registers[REGISTER_COUNT]{};
 
 	// Timers -  as long as their value is above 0, they should be decremented by one, 60 times per second (ie. at 60 Hz)
 	// independent of the speed of the fetch/decode/execute loop
 	// Delay timer: decremented at a rate of 60Hz until it reaches 0
 	// Sound timer: decremented at a rate of 60Hz until it reaches 0. When non-zero, the system should make a beeping sound
-	uint8_t delayTimer;
-	uint8_t soundTimer;
+	uint8_t delayTimer = 0;
+	uint8_t soundTimer = 0;
 
-	// 16 registers, from V0 to VF. VF is also used as a flag by some instructions
-	uint8_t registers[REGISTER_COUNT]{};
-	uint8_t * VF = &registers[15];
+	// Which interpreter's quirks to emulate (picks the Run specialisation)
+	Variant variant = Variant::Chip8;
+
+	// Hi-res (128x64) mode and the planes DXYN/00E0/scrolling act on (bitmask, XO-CHIP)
+	bool hires = false;
+	uint8_t planeMask = 0x1;
+
+	// Set by DXYN when the variant waits for the display; cleared on the next timer tick
+	bool waitingForVBlank = false;
 
-	// Keypad mapping:
+	// Set by 00FD (SUPER-CHIP exit)
+	bool halted = false;
+
+	// Idle-loop detection. A program that spins polling the delay timer or a key
+	// makes no progress until a timer tick or key change, so Run skips the whole
+	// iterations left in its budget instead of burning host cycles on them, and
+	// runs only the last partial one: it ends where a run without the skip would.
+	// Set by FX0A with no key down, or by a backward jump that finds the machine
+	// exactly as it was the last time it took that jump with no memory or display
+	// writes in between. Cleared by TickTimers and SetKey.
+	bool idle = false;
+
+	// Keypad, one bit per key (bit N = key N down). Mapping:
 	// 	Keypad       Keyboard
 	// +-+-+-+-+    +-+-+-+-+
 	// |1|2|3|C|    |1|2|3|4|
@@ -50,36 +72,289 @@ public:
 	// +-+-+-+-+    +-+-+-+-+
 	// |A|0|B|F|    |Z|X|C|V|
 	// +-+-+-+-+    +-+-+-+-+
-	uint8_t keypad[16]{};
+	uint16_t keypad = 0;
+
+	// Memory and display writes so far, so a loop with side effects is never called idle
+	alignas(64) uint32_t writeCount = 0;
+
+	// Instructions run (or skipped as idle) by Run so far, so an idle loop's length is known
+	uint64_t instructionCount = 0;
+
+#ifdef CHIP8_STATE_HASH
+	// XOR over every non-zero memory byte / display word of a hash of its position
+	// and value, updated as they're written (Write, DXYN) so StateHash never has to
+	// read the 64KB of memory or the display. Anything that writes `display`
+	// directly, or `memory` other than through Write, must call RehashState.
+	// The display's is kept per plane, so clearing a plane is O(1) too.
+	uint64_t memoryHash = 0;
+	uint64_t displayHash[DISPLAY_PLANES]{};
+#endif
+
+	// COSMAC VIP timing (RunTimed only): machine cycles since power-on, and the
+	// cycle the next 60Hz interrupt fires on
+	uint64_t machineCycles = 0;
+	uint64_t nextInterrupt = VIP_CYCLES_PER_FRAME;
+
+	// CXNN's generator. Part of the machine state: the same seed replays the same run.
+	Random random;
+
+	// SUPER-CHIP/XO-CHIP "RPL user flags" saved and restored by FX75/FX85
+	uint8_t flagRegisters[FLAG_REGISTER_COUNT]{};
+
+	// XO-CHIP audio: a 128-sample 1-bit pattern (F002) played back at 4000*2^((pitch-64)/48) Hz (FX3A)
+	// while the sound timer is non-zero. Defaults to a 500Hz square wave so every ROM gets a beep.
+	uint8_t audioPattern[AUDIO_PATTERN_SIZE] = { 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0 };
+	uint8_t audioPitch = 64;
+
+	// Display, 64x32 pixels (128x64 in hi-res mode), up to 4 bit planes on XO-CHIP
+	// Each pixel is either on or off in each plane. Rows are bit-packed, 64 pixels per word with
+	// the leftmost pixel in the top bit, so scrolling is a word shift. Lo-res uses word 0 of rows 0-31.
+	// (originally updates at 60Hz, for simplicity we'll redraw it when executing instructions that change the display)
+	alignas(64) uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS]{};
+
+	// Memory map (4096 bytes, 64KB on XO-CHIP):
+	// 0x000-0x1FF: Reserved. Store fontset somewhere in here (050–09F, big font 0A0-13F)
+	// 0x200-0xFFF: Instructions from the ROM
+	// The font and ROM pages are shared with every other machine (and the ROM
+	// image); a machine only owns the pages it has written. Use Read and Write.
+	alignas(64) PagedMemory memory;
 
 	// Methods *******************************************************************
 	// Setup
 	Chip8();
-	void LoadROM(char const* filename);
+
+	// Back to the power-on state (fonts loaded, everything else cleared), as one copy
+	// from a machine built once, instead of constructing a new one
+	void Reset();
+	// Copy a validated ROM image to 0x200 and take its detected variant
+	void LoadROM(const RomImage& rom);
 
 	// CPU Loop
 	void Cycle();
-	std::string DecodeAndExecute(uint16_t opcode);
-	
+
+	// Run up to `cycles` instructions and return how many executed.
+	// Run<true> checks the debugger before every instruction and stops on a hit;
+	// Run<false> is the plain loop and never looks at breakpoints.
+	// Both dispatch once on `variant` to a loop specialised for its quirks.
+	template <bool Debug>
+	int Run(int cycles, Debugger* debugger = nullptr);
+
+	// COSMAC VIP timing: run until `machineCycles` reaches `targetCycle` and return
+	// the instructions executed. Each instruction costs what the VIP interpreter
+	// spends on it, and the machine fires its own 60Hz interrupt (timers, display
+	// wait) on the exact cycle, so the caller hands out a cycle budget and never
+	// calls TickTimers. Waiting (idle loop, display wait) uses up the budget the
+	// way it would on the VIP. A separate specialisation: Run is unchanged.
+	template <bool Debug>
+	int RunTimed(uint64_t targetCycle, Debugger* debugger = nullptr);
+
+	// `limit` is an instruction count, or with Timed the machine cycle to stop at
+	template <typename Quirks, bool Debug, bool Timed>
+	int RunVariant(uint64_t limit, Debugger* debugger);
+
+	// 60Hz tick: decrement the delay and sound timers and release the display wait / idle loop
+	void TickTimers();
+
+	// Press or release a keypad key, waking the CPU if it was idle
+	void SetKey(uint8_t key, bool pressed);
+	bool IsKeyDown(uint8_t key) const { return (keypad >> (key & 0xF)) & 1; }
+
+	// Fingerprint of everything that decides what the machine does next (CPU,
+	// timers, display, memory, random state; not the keypad or bookkeeping such
+	// as idle detection and write counts). Equal states hash equal, so searches
+	// can dedupe them. With CHIP8_STATE_HASH it costs the same as hashing the
+	// registers; without, it reads the display and memory (only XO-CHIP's past
+	// the first 4KB).
+	uint64_t StateHash() const;
+
+	// Recompute memoryHash and displayHash from scratch, after writing `display`
+	// other than through the instructions. Does nothing without CHIP8_STATE_HASH.
+	void RehashState();
+
+	// One byte / display word's share of memoryHash / displayHash. Zero contributes nothing,
+	// so cleared memory and a blank display hash to 0.
+	static uint64_t PositionHash(uint32_t position, uint64_t value)
+	{
+		// One multiply on the dependency chain (the position's key doesn't depend on the value)
+		uint64_t z = (value ^ ((position + 1) * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+		return (z ^ (z >> 32)) & (0 - static_cast<uint64_t>(value != 0));
+	}
+	static unsigned int DisplayPosition(unsigned int plane, unsigned int row, unsigned int word)
+	{
+		return (plane * DISPLAY_HEIGHT + row) * DISPLAY_ROW_WORDS + word;
+	}
+
+	// Decode an instruction into its mnemonic without executing it
+	static std::string Disassemble(uint16_t opcode);
+
+	// Visible display size for the current mode
+	unsigned int DisplayWidth() const { return hires ? DISPLAY_WIDTH : LORES_WIDTH; }
+	unsigned int DisplayHeight() const { return hires ? DISPLAY_HEIGHT : LORES_HEIGHT; }
+
+	// Bit planes that are set at (x, y), plane 0 in bit 0. 0 means the pixel is off.
+	uint8_t GetPixel(unsigned int x, unsigned int y) const
+	{
+		uint8_t value = 0;
+		for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+		{
+			value |= ((display[plane][y][x >> 6] >> (63 - (x & 63))) & 1) << plane;
+		}
+		return value;
+	}
+
+	// Memory access used by the instructions
+	uint8_t Read(uint16_t address) const { return memory.Read(address); }
+	void Write(uint16_t address, uint8_t value)
+	{
+#ifdef CHIP8_STATE_HASH
+		memoryHash ^= PositionHash(address, memory.Read(address)) ^ PositionHash(address, value);
+#endif
+		memory.Write(address, value);
+		++writeCount;
+	}
+
+	// Decode and execute a single instruction with the given quirks
+	template <typename Quirks>
+	void Execute(uint16_t opcode);
+
     // Instructions **************************************************************
 	// Clear screen
     void OP_00E0();
 
+	// Return from subroutine
+	void OP_00EE();
+
+	// Scroll the selected planes down / up N rows, right / left 4 pixels (SUPER-CHIP, up is XO-CHIP)
+	void OP_00CN(uint8_t rows);
+	void OP_00DN(uint8_t rows);
+	void OP_00FB();
+	void OP_00FC();
+
+	// Exit the interpreter (SUPER-CHIP)
+	void OP_00FD();
+
+	// Switch to lo-res / hi-res mode, clearing the screen
+	void OP_00FE();
+	void OP_00FF();
+
 	// Jump
 	void OP_1NNN(uint16_t address);
 
+	// Call subroutine
+	void OP_2NNN(uint16_t address);
+
+	// Skip if VX == NN / VX != NN
+	template <typename Quirks> void OP_3XNN(uint8_t Vx, uint8_t byte);
+	template <typename Quirks> void OP_4XNN(uint8_t Vx, uint8_t byte);
+
+	// Skip if VX == VY / VX != VY
+	template <typename Quirks> void OP_5XY0(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_9XY0(uint8_t Vx, uint8_t Vy);
+
+	// Save / load the register range VX..VY at I without changing I (XO-CHIP)
+	void OP_5XY2(uint8_t Vx, uint8_t Vy);
+	void OP_5XY3(uint8_t Vx, uint8_t Vy);
+
 	// Set register VX
 	void OP_6XNN(uint8_t Vx, uint8_t byte);
 
 	// Add value to register VX
 	void OP_7XNN(uint8_t Vx, uint8_t byte);
 
+	// Logical and arithmetic instructions
+	void OP_8XY0(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_8XY1(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_8XY2(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_8XY3(uint8_t Vx, uint8_t Vy);
+	void OP_8XY4(uint8_t Vx, uint8_t Vy);
+	void OP_8XY5(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_8XY6(uint8_t Vx, uint8_t Vy);
+	void OP_8XY7(uint8_t Vx, uint8_t Vy);
+	template <typename Quirks> void OP_8XYE(uint8_t Vx, uint8_t Vy);
+
 	// Set index register
 	void OP_ANNN(uint16_t address);
 
-	// Display/Draw
-	void OP_DXYN(uint8_t Vx, uint8_t Vy, uint8_t height);
-};
+	// VX = random byte & NN
+	void OP_CXNN(uint8_t Vx, uint8_t byte);
+
+	// Jump with offset (BNNN, or BXNN on SUPER-CHIP)
+	template <typename Quirks> void OP_BNNN(uint16_t address);
 
+	// Display/Draw (DXY0 draws a 16x16 sprite on SUPER-CHIP/XO-CHIP)
+	template <typename Quirks> void OP_DXYN(uint8_t Vx, uint8_t Vy, uint8_t height);
 
+	// Skip if key VX is / isn't pressed
+	template <typename Quirks> void OP_EX9E(uint8_t Vx);
+	template <typename Quirks> void OP_EXA1(uint8_t Vx);
+
+	// I = 16-bit address in the next word (XO-CHIP F000 NNNN)
+	void OP_F000();
+
+	// Select the bit planes to draw to (XO-CHIP FN01)
+	void OP_FN01(uint8_t mask);
+
+	// Load the audio pattern from I / set the playback pitch (XO-CHIP)
+	void OP_F002();
+	void OP_FX3A(uint8_t Vx);
+
+	// Timers
+	void OP_FX07(uint8_t Vx);
+	void OP_FX15(uint8_t Vx);
+	void OP_FX18(uint8_t Vx);
+
+	// Wait for a key press
+	void OP_FX0A(uint8_t Vx);
+
+	// Index register arithmetic, font character, big font character, BCD
+	void OP_FX1E(uint8_t Vx);
+	void OP_FX29(uint8_t Vx);
+	void OP_FX30(uint8_t Vx);
+	void OP_FX33(uint8_t Vx);
+
+	// Store / load registers V0..VX at I
+	template <typename Quirks> void OP_FX55(uint8_t Vx);
+	template <typename Quirks> void OP_FX65(uint8_t Vx);
+
+	// Save / load V0..VX to the flag registers
+	void OP_FX75(uint8_t Vx);
+	void OP_FX85(uint8_t Vx);
+
+private:
+	// Skip the next instruction; XO-CHIP skips F000 NNNN as a whole
+	template <typename Quirks> void SkipNext();
+
+	// Everything a polling loop can read or change, captured at a backward jump
+	struct LoopState
+	{
+		uint64_t random; // a loop that draws random numbers is never idle
+		uint8_t registers[REGISTER_COUNT];
+		uint16_t stack[STACK_SIZE];
+		uint16_t index = 0;
+		uint8_t sp = 0;
+		uint8_t delayTimer = 0;
+		uint8_t soundTimer = 0;
+		uint8_t planeMask;
+		bool hires;
+	};
+	LoopState idleProbe{};
+	uint16_t idleProbeJump = 0xFFFF;
+	uint32_t idleProbeWrites = 0;
+
+	// Machine cycle and instruction count of the last probe, so a run can skip whole loop iterations
+	uint64_t idleProbeCycles = 0;
+	uint64_t idleProbeInstructions = 0;
+
+	// The selected planes changed in bulk (scroll, mode switch)
+	void RehashDisplay(uint8_t planes);
+
+	// Called after a backward jump from `jumpAddress`, `executed` instructions into
+	// this Run; sets `idle` if the loop can't make progress
+	void CheckIdleLoop(uint16_t jumpAddress, uint64_t executed);
+
+	// VIP timing: the interpreter's cost for `opcode` (fetch included, skip not) given
+	// the current registers, and the 60Hz interrupt
+	uint32_t VipCycles(uint16_t opcode) const;
+	void VipInterrupt();
+};
 
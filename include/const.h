@@ -1,23 +1,73 @@
 
 #ifndef CHIP8_CONST_H
 #define CHIP8_CONST_H
+#include <cstdint>
 
 // Memory Constants ****************************
-const unsigned int MEMORY_SIZE = 4096;
+// 64KB for XO-CHIP. CHIP-8 and SUPER-CHIP programs only ever use the first 4KB.
+const unsigned int MEMORY_SIZE = 0x10000;
 const unsigned int PC_START_ADDRESS = 0x200;
 const unsigned int STACK_SIZE = 16;
 const unsigned int REGISTER_COUNT = 16;
 
+// Memory is shared between machines copy-on-write in pages of this size (see PagedMemory).
+// The ROM starts on a page boundary, so its pages never hold the fonts.
+const unsigned int MEMORY_PAGE_SIZE = 256;
+const unsigned int MEMORY_PAGE_COUNT = MEMORY_SIZE / MEMORY_PAGE_SIZE;
+
 // Display Constants ***************************
-const unsigned int DISPLAY_WIDTH = 64;
-const unsigned int DISPLAY_HEIGHT = 32;
+// The framebuffer is sized for SUPER-CHIP/XO-CHIP hi-res mode (128x64).
+// Lo-res mode (64x32) uses the top-left corner of it.
+const unsigned int DISPLAY_WIDTH = 128;
+const unsigned int DISPLAY_HEIGHT = 64;
 const unsigned int DISPLAY_SIZE = DISPLAY_WIDTH * DISPLAY_HEIGHT;
+const unsigned int LORES_WIDTH = 64;
+const unsigned int LORES_HEIGHT = 32;
+
+// Pixels are bit-packed, 64 per word with the leftmost pixel in the top bit,
+// so a hi-res row is 2 words. XO-CHIP draws to up to 4 bit planes.
+const unsigned int DISPLAY_ROW_WORDS = DISPLAY_WIDTH / 64;
+const unsigned int DISPLAY_PLANES = 4;
+
+// Colours for each combination of bit planes, 0xAABBGGRR (R, G, B, A bytes in memory on little-endian hosts).
+// Plane 0 alone is white so plain CHIP-8 stays black and white.
+static const uint32_t displayPalette[16] =
+{
+	0xFF000000, 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555,
+	0xFF0000FF, 0xFF00FF00, 0xFFFF0000, 0xFF00FFFF,
+	0xFFFF00FF, 0xFFFFFF00, 0xFF000080, 0xFF008000,
+	0xFF800000, 0xFF008080, 0xFF800080, 0xFF808000
+};
+
+// COSMAC VIP Timing Constants *****************
+// The VIP's 1802 takes 8 clocks per machine cycle at 1.76064MHz: 220080 machine
+// cycles a second, 3668 per 60Hz frame. Every frame the CDP1861 video chip
+// takes 1024 of them for display DMA (128 lines of 8 bytes), and the interrupt
+// routine that counts the timers down about 46 more.
+const unsigned int VIP_CYCLES_PER_SECOND = 220080;
+const unsigned int VIP_CYCLES_PER_FRAME = VIP_CYCLES_PER_SECOND / 60;
+const unsigned int VIP_INTERRUPT_CYCLES = 1024 + 46;
+
+// The interpreter's fetch/decode loop, run before every instruction, and the
+// extra cost of a skip instruction taking its skip
+const unsigned int VIP_FETCH_CYCLES = 40;
+const unsigned int VIP_SKIP_CYCLES = 4;
 
 // Font Data Constants *************************
 const unsigned int FONT_SIZE = 16 * 5;
 const unsigned int FONT_START_ADDRESS = 0x50;
 const unsigned int FONT_END_ADDRESS = 0x9F;
 
+// SUPER-CHIP big font (FX30) sits right after the small one, 10 bytes per character
+const unsigned int BIG_FONT_SIZE = 16 * 10;
+const unsigned int BIG_FONT_START_ADDRESS = 0xA0;
+
+// SUPER-CHIP/XO-CHIP persistent "RPL user flags" (FX75/FX85)
+const unsigned int FLAG_REGISTER_COUNT = 16;
+
+// XO-CHIP audio pattern buffer (F002), 128 1-bit samples
+const unsigned int AUDIO_PATTERN_SIZE = 16;
+
 // 16 characters, 5 bytes per character
 static uint8_t font[FONT_SIZE] =
 {
@@ -0,0 +1,73 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <vector>
+#include "const.h"
+
+class Chip8;
+
+// Breakpoints and watchpoints for the debug run loop (Chip8::Run<true>).
+// Addresses are kept in per-address bitmaps so a check is a single bit test,
+// and nothing here is touched by the non-debug run loop.
+class Debugger
+{
+public:
+	// Register comparison used by conditional breakpoints
+	enum class Compare { Equal, NotEqual, Less, Greater };
+
+	// Break when register V[reg] <cmp> value becomes true
+	struct Condition {
+		uint8_t reg;
+		Compare cmp;
+		uint8_t value;
+		bool enabled;
+		bool wasTrue; // conditions are edge-triggered, so resuming doesn't re-break immediately
+	};
+
+	enum class HitType { None, Breakpoint, Condition, ReadWatch, WriteWatch };
+
+	// What stopped the run loop. address is the PC for breakpoints/conditions
+	// and the accessed memory address for watchpoints.
+	struct Hit {
+		HitType type = HitType::None;
+		uint16_t pc = 0;
+		uint16_t address = 0;
+	};
+
+	// PC breakpoints and memory watchpoints, one bit per address
+	std::bitset<MEMORY_SIZE> breakpoints;
+	std::bitset<MEMORY_SIZE> readWatch;
+	std::bitset<MEMORY_SIZE> writeWatch;
+	std::vector<Condition> conditions;
+
+	// Setup
+	void ToggleBreakpoint(uint16_t address);
+	void AddCondition(uint8_t reg, Compare cmp, uint8_t value);
+	void SetWatch(uint16_t start, uint16_t end, bool onRead, bool onWrite); // inclusive range
+	void ClearWatch(uint16_t start, uint16_t end);
+	void ClearAll();
+
+	// True if anything is set, so the main loop can pick the debug run loop
+	bool IsActive() const;
+
+	// Called before every instruction on the debug path. Returns true (and records
+	// the hit) if the instruction at PC should not execute.
+	bool Check(const Chip8& chip8);
+
+	// Skip the checks for the next instruction so continuing from a hit makes progress
+	void Resume() { skipNext = true; }
+
+	const Hit& LastHit() const { return lastHit; }
+	void ClearHit() { lastHit = Hit(); }
+
+	// True once per hit, so the caller can tell a hit from a run that stopped for another reason
+	bool ConsumeHit();
+
+private:
+	Hit lastHit;
+	bool hitPending = false;
+	bool skipNext = false;
+
+	bool CheckAccess(const Chip8& chip8, uint16_t opcode);
+	bool Record(HitType type, uint16_t pc, uint16_t address);
+};
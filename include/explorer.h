@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Chip8;
+
+// State-space exploration.
+// Searches the keypad inputs a program can be given, one input held for a few
+// frames per step, breadth-first or as a beam search. Every state reached is
+// fingerprinted (Chip8::StateHash) into a shared table, so a state reached by
+// two input sequences is only explored once. States are ranked by how many
+// instruction addresses they executed that nothing before them had, and the
+// input sequences that first reach new addresses are reported, e.g. as test
+// inputs or to get to deep game states without playing there by hand.
+// Each step's states are expanded in parallel from copies of their parents.
+// Results don't depend on the thread count or scheduling: when several
+// sequences reach one state, the earliest (shortest, then lowest input) wins.
+
+struct ExploreOptions
+{
+	unsigned int depth = 60;            // steps to search
+	unsigned int beam = 256;            // states kept per step, best first; 0 keeps them all (breadth-first)
+	unsigned int stepFrames = 4;        // 60Hz frames each input is held for
+	unsigned int cyclesPerFrame = 12;   // instructions per frame, x4 in hi-res, as in the headless runner
+	std::vector<uint16_t> inputs;       // keypad states (bit N = key N) to try each step; empty: none, then each key alone
+	unsigned int threads = 0;           // 0: one per core
+	size_t maxStates = size_t(1) << 22; // visited-state table size; the search stops when it fills
+};
+
+// An input sequence that executed instructions no earlier sequence had
+struct ExploreDiscovery
+{
+	std::vector<uint16_t> inputs;   // keypad state per step
+	std::vector<uint16_t> addresses; // the new instruction addresses, ascending
+};
+
+struct ExploreResult
+{
+	uint64_t expanded = 0;          // states run (including ones that turned out to be seen already)
+	uint64_t unique = 0;            // distinct states found
+	unsigned int depth = 0;         // steps completed
+	size_t covered = 0;             // distinct instruction addresses executed
+	bool tableFull = false;
+	float elapsedMs = 0.0f;
+	std::vector<ExploreDiscovery> discoveries;
+};
+
+// Lock-free set of 64-bit state hashes, each owned by the lowest id inserted
+// with it. Open addressing with linear probing in a fixed table: insertion is
+// a compare-and-swap on the slot, so any number of threads can insert at once.
+class StateSet
+{
+public:
+	// Room for `capacity` hashes (rounded up to a power of two). Fills at 3/4.
+	explicit StateSet(size_t capacity);
+
+	// Add `hash` on behalf of `owner`, keeping the lowest owner. False if the table is full.
+	bool Insert(uint64_t hash, uint64_t owner);
+
+	// The lowest owner `hash` was inserted with, or UINT64_MAX
+	uint64_t Owner(uint64_t hash) const;
+
+	size_t Size() const { return size.load(std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> hash{0};
+		std::atomic<uint64_t> owner{UINT64_MAX};
+	};
+	std::unique_ptr<Slot[]> slots;
+	size_t mask = 0;
+	size_t limit = 0;
+	std::atomic<size_t> size{0};
+};
+
+// Search from `start`. The starting machine is left alone.
+ExploreResult Explore(const Chip8& start, const ExploreOptions& options);
+
+// "- 5 5 4 -": each step's keys as hex digits, - for none
+std::string FormatInputs(const std::vector<uint16_t>& inputs);
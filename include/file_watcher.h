@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Watches one file for changes on a background thread using inotify.
+// The thread sleeps in the kernel until something happens, so there's no
+// polling, and the main loop only ever reads an atomic flag.
+// The containing directory is watched rather than the file, so editors and
+// build tools that replace the file (write a temp file, rename over) are seen too.
+// On platforms without inotify, Watch() returns false and nothing is reported.
+class FileWatcher
+{
+public:
+	FileWatcher() = default;
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Start watching `path`, replacing any previous watch
+	bool Watch(const std::string& path);
+	void Stop();
+
+	// True once after the file changed (several writes in quick succession count once)
+	bool ConsumeChange() { return changed.exchange(false, std::memory_order_acq_rel); }
+
+private:
+	void Worker(int inotifyFd, int wakeFd, std::string fileName);
+
+	std::thread thread;
+	std::atomic<bool> changed{false};
+	int stopFd = -1; // written to wake the thread up for shutdown
+};
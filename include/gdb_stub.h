@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Chip8;
+class Debugger;
+
+// GDB remote serial protocol stub, so an external debugger can attach to a
+// running instance over localhost TCP or a UNIX socket.
+//
+// A background thread owns the socket and speaks the protocol; it never
+// touches the machine. Anything that reads or changes machine state is handed
+// to the emulation loop, which answers it from Service() between instruction
+// batches, so neither the emulation nor the render loop ever waits on the
+// debugger. While GDB has the target stopped, IsStopped() is true and the
+// caller must not run the CPU.
+//
+// Registers (GDB numbering): 0-15 V0-VF, 16 I, 17 PC, 18 SP, 19 DT, 20 ST.
+// Breakpoints (Z0/Z1) and watchpoints (Z2 write, Z3 read, Z4 access) go
+// through the Debugger, so they also show up in the Breakpoints window.
+class GdbStub
+{
+public:
+	GdbStub() = default;
+	~GdbStub();
+
+	GdbStub(const GdbStub&) = delete;
+	GdbStub& operator=(const GdbStub&) = delete;
+
+	// Listen on `address`: a TCP port on 127.0.0.1, or a UNIX socket path.
+	// With `waitForClient` the machine counts as stopped until a debugger attaches and continues.
+	bool Start(const std::string& address, bool waitForClient, std::string& error);
+	void Stop();
+
+	// Emulation loop, once per iteration, whether or not a ROM is loaded: answer
+	// pending requests, perform a requested single step (a VIP-timed one with `vipTiming`)
+	void Service(Chip8& chip8, Debugger& debugger, bool vipTiming);
+
+	// Emulation loop: the run stopped on a breakpoint/watchpoint while a debugger was attached
+	void ReportBreak();
+
+	bool IsAttached() const { return attached.load(std::memory_order_acquire); }
+	bool IsStopped() const;
+
+private:
+	enum class RunState { Running, Stopped, Stepping };
+
+	void Worker(int listenFd);
+	void Serve(int clientFd);
+	bool SendPacket(int clientFd, const std::string& payload);
+	std::string Handle(const std::string& packet, bool& sendReply);
+	std::string HandleMachine(const std::string& packet, Chip8& chip8, Debugger& debugger, bool& sendReply);
+	void QueueStopReply(const std::string& reply);
+	void Wake();
+
+	std::thread thread;
+	std::atomic<bool> stopping{false};
+	std::atomic<bool> attached{false};
+	std::atomic<bool> interruptRequested{false};
+	bool holdUntilAttached = false;
+	int wakePipe[2] = { -1, -1 };
+	std::string unixPath;
+	bool noAck = false;
+
+	// Handoff between the socket thread and the emulation loop
+	mutable std::mutex mutex;
+	std::condition_variable replied;
+	RunState state = RunState::Running;
+	std::string request;            // packet waiting for Service()
+	bool requestPending = false;
+	std::string reply;
+	bool replyReady = false;
+	bool replyWanted = false;
+	std::vector<std::string> stopReplies; // asynchronous stop notifications for the socket thread to send
+};
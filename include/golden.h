@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "quirks.h"
+
+// Golden-state regression runs.
+// A manifest lists ROMs to run headless for a fixed number of frames. The end
+// state (display hash, registers, timers, stack) is compared with a golden
+// file next to the ROM, so any change in behaviour of the instructions or the
+// dispatch path shows up as a diff. Cases run in parallel.
+//
+// Manifest format, one case per line, paths relative to the manifest, # for comments:
+//   <rom> <frames> [chip8|schip|xochip] [keys]
+// `keys` is a hex digit string of keypad keys held down for the whole run.
+// The golden file is <rom>.golden next to the manifest, or <rom>.<variant>.golden
+// when the case names a variant, so one ROM can be checked under each.
+
+struct GoldenCase
+{
+	std::string name;            // <rom> as written in the manifest, plus .<variant> if given
+	std::string rom;
+	std::string golden;          // <name>.golden
+	unsigned int frames = 0;
+	bool hasVariant = false;     // otherwise detected from the ROM
+	Variant variant = Variant::Chip8;
+	std::string keys;
+};
+
+// Read a manifest. ROMs are looked up in `romDirectory` if given (e.g. ROMs
+// assembled into a build tree), otherwise next to the manifest. Returns false
+// and sets `error` on a malformed line.
+bool LoadGoldenManifest(const std::string& path, std::vector<GoldenCase>& cases, std::string& error, const std::string& romDirectory = "");
+
+// Run one case and describe the end state, in golden file format
+bool RunGoldenCase(const GoldenCase& test, std::string& state, std::string& error);
+
+// Run every case on `threads` threads (0: one per core) and print a line per
+// case. With `update`, write the golden files instead of comparing.
+// Returns the number of failed cases.
+int RunGoldenSuite(const std::vector<GoldenCase>& cases, bool update, unsigned int threads = 0);
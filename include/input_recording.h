@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "const.h"
+
+class Chip8;
+
+// Everything from outside the CPU that a run depends on: the random seed, and
+// timer ticks and key changes, each stamped with the number of instructions executed before it.
+// With VIP timing the machine ticks its own timers, and key changes are stamped with the machine cycle.
+// Replaying them onto a freshly loaded machine reproduces the run exactly, so
+// a rebuilt ROM can be brought back to the same point instead of replayed by hand.
+class InputRecording
+{
+public:
+	// Start over (ROM loaded or reset), from `chip8`'s current random state
+	void Clear(const Chip8& chip8, bool vipTiming = false);
+
+	// Count instructions (VIP timing: machine cycles) as they're executed
+	void Executed(uint64_t cycles) { cycle += cycles; }
+
+	// Record a 60Hz timer tick / a key change, at the current instruction count
+	void Tick();
+	void Key(uint8_t key, bool pressed);
+
+	// Run `chip8` (freshly loaded) through the recorded inputs, up to the same instruction count
+	void Replay(Chip8& chip8) const;
+
+	uint64_t Cycles() const { return cycle; }
+	size_t Frames() const { return timed ? cycle / VIP_CYCLES_PER_FRAME : frames; }
+
+private:
+	enum EventType : uint8_t { TICK, KEY_DOWN, KEY_UP };
+
+	struct Event
+	{
+		uint64_t cycle;
+		EventType type;
+		uint8_t key;
+	};
+
+	std::vector<Event> events;
+	uint64_t randomState = 0;
+	bool timed = false;
+	uint64_t cycle = 0;
+	size_t frames = 0;
+};
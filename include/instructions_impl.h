@@ -0,0 +1,212 @@
+#pragma once
+#include "chip8.h"
+#include "quirks.h"
+
+// The quirk-dependent instructions. They're defined here rather than in
+// instructions.cpp so Chip8::Execute<Quirks> sees their bodies and each
+// variant's interpreter loop inlines them.
+
+// Skip next instruction if VX == NN
+template <typename Quirks>
+void Chip8::OP_3XNN(uint8_t Vx, uint8_t byte){
+	if (registers[Vx] == byte) SkipNext<Quirks>();
+}
+
+// Skip next instruction if VX != NN
+template <typename Quirks>
+void Chip8::OP_4XNN(uint8_t Vx, uint8_t byte){
+	if (registers[Vx] != byte) SkipNext<Quirks>();
+}
+
+// Skip next instruction if VX == VY
+template <typename Quirks>
+void Chip8::OP_5XY0(uint8_t Vx, uint8_t Vy){
+	if (registers[Vx] == registers[Vy]) SkipNext<Quirks>();
+}
+
+// Skip next instruction if VX != VY
+template <typename Quirks>
+void Chip8::OP_9XY0(uint8_t Vx, uint8_t Vy){
+	if (registers[Vx] != registers[Vy]) SkipNext<Quirks>();
+}
+
+// VX |= VY
+template <typename Quirks>
+void Chip8::OP_8XY1(uint8_t Vx, uint8_t Vy){
+	registers[Vx] |= registers[Vy];
+	if constexpr (Quirks::logicResetsVF) registers[0xF] = 0;
+}
+
+// VX &= VY
+template <typename Quirks>
+void Chip8::OP_8XY2(uint8_t Vx, uint8_t Vy){
+	registers[Vx] &= registers[Vy];
+	if constexpr (Quirks::logicResetsVF) registers[0xF] = 0;
+}
+
+// VX ^= VY
+template <typename Quirks>
+void Chip8::OP_8XY3(uint8_t Vx, uint8_t Vy){
+	registers[Vx] ^= registers[Vy];
+	if constexpr (Quirks::logicResetsVF) registers[0xF] = 0;
+}
+
+// VX >>= 1, VF = bit shifted out
+template <typename Quirks>
+void Chip8::OP_8XY6(uint8_t Vx, uint8_t Vy){
+	uint8_t value = Quirks::shiftUsesVy ? registers[Vy] : registers[Vx];
+	registers[Vx] = value >> 1;
+	registers[0xF] = value & 0x1;
+}
+
+// VX <<= 1, VF = bit shifted out
+template <typename Quirks>
+void Chip8::OP_8XYE(uint8_t Vx, uint8_t Vy){
+	uint8_t value = Quirks::shiftUsesVy ? registers[Vy] : registers[Vx];
+	registers[Vx] = value << 1;
+	registers[0xF] = value >> 7;
+}
+
+// Jump with offset
+template <typename Quirks>
+void Chip8::OP_BNNN(uint16_t address){
+	// SUPER-CHIP reads this as BXNN and adds VX instead of V0
+	uint8_t offsetRegister = Quirks::jumpUsesVx ? (address >> 8) : 0;
+	pc = address + registers[offsetRegister];
+}
+
+// Display/Draw
+template <typename Quirks>
+void Chip8::OP_DXYN(uint8_t Vx, uint8_t Vy, uint8_t height){
+	// Draws a sprite at coordinate (VX, VY) that has a width of 8 pixels and a height of N pixels.
+	// On SUPER-CHIP/XO-CHIP, N = 0 draws a 16x16 sprite (2 bytes per row).
+	// index register points to the location in memory where the sprite's data is stored,
+	// one sprite per selected plane, back to back.
+	// All the pixels are XORed onto the existing screen.
+	unsigned int width = 8;
+	if constexpr (Quirks::superChipOps)
+	{
+		if (height == 0)
+		{
+			width = 16;
+			height = 16;
+		}
+	}
+	unsigned int bytesPerRow = width / 8;
+
+	unsigned int screenWidth = DisplayWidth();
+	unsigned int screenHeight = DisplayHeight();
+
+	// Get coordinates from registers and wrap around if going beyond screen boundaries
+	unsigned int xPos = registers[Vx] % screenWidth;
+	unsigned int yPos = registers[Vy] % screenHeight;
+
+	registers[0xF] = 0; // reset collision flag
+	++writeCount;
+
+	unsigned int spriteIndex = 0;
+	for(unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planeMask & (1 << plane))) continue;
+
+		// Each selected plane takes the next sprite in memory, even if rows get clipped
+		uint16_t address = index + spriteIndex++ * height * bytesPerRow;
+
+		// For each row of the sprite
+		for(unsigned int row = 0; row < height; ++row, address += bytesPerRow)
+		{
+			// Stop if we reach the bottom of the screen (or wrap to the top)
+			if constexpr (Quirks::clipSprites)
+			{
+				if((yPos + row) >= screenHeight) break;
+			}
+			unsigned int y = (yPos + row) % screenHeight;
+
+			// Sprite row, left-aligned in a word so the leftmost pixel is the top bit
+			uint64_t bits = Read(address);
+			if (width == 16) bits = bits << 8 | Read(address + 1);
+			bits <<= 64 - width;
+
+			// Shift it into place across the row's words. Pixels pushed past the
+			// right edge are dropped when clipping and come back on the left when wrapping.
+			uint64_t mask[DISPLAY_ROW_WORDS] = {};
+			uint64_t overflow = 0;
+			unsigned int word = xPos >> 6;
+			unsigned int shift = xPos & 63;
+			mask[word] = bits >> shift;
+			if (shift)
+			{
+				if (word + 1 < screenWidth / 64) mask[word + 1] = bits << (64 - shift);
+				else overflow = bits << (64 - shift);
+			}
+			if constexpr (!Quirks::clipSprites)
+			{
+				mask[0] |= overflow;
+			}
+
+			uint64_t* screenRow = display[plane][y];
+			for(unsigned int w = 0; w < DISPLAY_ROW_WORDS; ++w)
+			{
+				// Check for collision (both sprite and screen pixels are on)
+				if(screenRow[w] & mask[w])
+				{
+					registers[0xF] = 1; // Set collision flag
+				}
+
+#ifdef CHIP8_STATE_HASH
+				if (mask[w]) displayHash[plane] ^= PositionHash(DisplayPosition(plane, y, w), screenRow[w]) ^ PositionHash(DisplayPosition(plane, y, w), screenRow[w] ^ mask[w]);
+#endif
+				// XOR the pixels (toggle them)
+				screenRow[w] ^= mask[w];
+			}
+		}
+	}
+
+	// The original interpreter waits for the vertical blank before drawing
+	if constexpr (Quirks::displayWait)
+	{
+		waitingForVBlank = true;
+	}
+}
+
+// Skip next instruction if key VX is pressed
+template <typename Quirks>
+void Chip8::OP_EX9E(uint8_t Vx){
+	if (IsKeyDown(registers[Vx])) SkipNext<Quirks>();
+}
+
+// Skip next instruction if key VX is not pressed
+template <typename Quirks>
+void Chip8::OP_EXA1(uint8_t Vx){
+	if (!IsKeyDown(registers[Vx])) SkipNext<Quirks>();
+}
+
+// Store V0..VX in memory starting at I
+template <typename Quirks>
+void Chip8::OP_FX55(uint8_t Vx){
+	for (unsigned int i = 0; i <= Vx; ++i)
+	{
+		Write(index + i, registers[i]);
+	}
+	if constexpr (Quirks::loadStoreBumpsI) index += Vx + 1;
+}
+
+// Load V0..VX from memory starting at I
+template <typename Quirks>
+void Chip8::OP_FX65(uint8_t Vx){
+	for (unsigned int i = 0; i <= Vx; ++i)
+	{
+		registers[i] = Read(index + i);
+	}
+	if constexpr (Quirks::loadStoreBumpsI) index += Vx + 1;
+}
+
+// Skip over the next instruction, which on XO-CHIP may be the 4-byte F000 NNNN
+template <typename Quirks>
+void Chip8::SkipNext(){
+	if constexpr (Quirks::xoChipOps)
+	{
+		if (Read(pc) == 0xF0 && Read(pc + 1) == 0x00) pc += 2;
+	}
+	pc += 2;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+class Chip8;
+
+// Keypad changes waiting for the emulation loop, each stamped with when it
+// happened on the host. The loop runs instructions in batches covering a span
+// of host time; rather than applying every key seen since the last batch at
+// its start, it splits the batch and applies each change at the instruction
+// boundary its timestamp falls on.
+class KeyEventQueue
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	struct Event
+	{
+		Clock::time_point time;
+		uint8_t key;
+		bool pressed;
+	};
+
+	void Push(uint8_t key, bool pressed, Clock::time_point time = Clock::now());
+	void Clear() { events.clear(); }
+
+	bool Empty() const { return events.empty(); }
+	const Event& Front() const { return events.front(); }
+	Event Pop();
+
+	// Instruction (0..cycles) of a batch of `cycles` starting at `batchStart`, `delay` ms apart, that `time` falls on
+	static int InstructionAt(Clock::time_point time, Clock::time_point batchStart, float delay, int cycles);
+
+private:
+	std::deque<Event> events;
+};
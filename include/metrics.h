@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Frame-time histogram bucket upper bounds in milliseconds; the last bucket is everything slower
+static const double FRAME_TIME_BUCKETS_MS[] = { 2, 4, 8, 12, 16, 17, 20, 25, 33, 50, 100 };
+static const unsigned int FRAME_TIME_BUCKET_COUNT = sizeof(FRAME_TIME_BUCKETS_MS) / sizeof(FRAME_TIME_BUCKETS_MS[0]) + 1;
+
+// Counters and gauges for a running instance.
+// Everything is a relaxed atomic with a single writer (the emulation loop),
+// bumped at most once per instruction batch or per frame with a plain load and
+// store, so collection costs nothing measurable next to emulation. Readers (the
+// performance panel, the exporter thread) take a Snapshot() and work out rates
+// from the difference between two.
+struct Metrics
+{
+	// Counters
+	std::atomic<uint64_t> instructions{0};
+	std::atomic<uint64_t> framesEmulated{0};  // 60Hz timer ticks
+	std::atomic<uint64_t> framesPresented{0}; // frames drawn to the window
+	std::atomic<uint64_t> textureUploads{0};
+	std::atomic<uint64_t> uiRenderMicros{0};  // total time spent building and drawing the UI
+	std::atomic<uint64_t> frameTimeBuckets[FRAME_TIME_BUCKET_COUNT] = {};
+	std::atomic<uint64_t> frameTimeMicros{0};
+	std::atomic<uint64_t> keyEvents{0};
+	std::atomic<uint64_t> inputLatencyMicros{0}; // key press to the first presented frame it changed, summed
+	std::atomic<uint64_t> inputLatencySamples{0};
+
+	// Gauges, set by whoever owns the thing being measured
+	std::atomic<uint64_t> framesDropped{0};   // capture frames dropped because the encoder fell behind
+	std::atomic<int64_t> timerDriftMicros{0}; // timer ticks vs wall clock; negative means the timers are behind
+	std::atomic<uint32_t> audioQueued{0};     // sound timer ticks waiting for the audio callback
+	std::atomic<uint32_t> captureQueued{0};   // frames waiting for the capture encoder
+	std::atomic<uint32_t> lastInputLatencyMicros{0};
+	std::atomic<uint32_t> firstFrameMicros{0};   // start-up to the first frame of the program emulated
+	std::atomic<uint32_t> firstPresentMicros{0}; // and to the first frame on screen (0: not yet)
+
+	// Writer side: no locked read-modify-write needed with one writer
+	static void Add(std::atomic<uint64_t>& counter, uint64_t amount)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	// Host time between two presented (or emulated, headless) frames
+	void RecordFrameTime(std::chrono::high_resolution_clock::duration duration);
+};
+
+// Plain copy of Metrics at one point in time
+struct MetricsSnapshot
+{
+	std::chrono::steady_clock::time_point time;
+	uint64_t instructions = 0;
+	uint64_t framesEmulated = 0;
+	uint64_t framesPresented = 0;
+	uint64_t textureUploads = 0;
+	uint64_t uiRenderMicros = 0;
+	uint64_t frameTimeBuckets[FRAME_TIME_BUCKET_COUNT] = {};
+	uint64_t frameTimeMicros = 0;
+	uint64_t keyEvents = 0;
+	uint64_t inputLatencyMicros = 0;
+	uint64_t inputLatencySamples = 0;
+	uint64_t framesDropped = 0;
+	int64_t timerDriftMicros = 0;
+	uint32_t audioQueued = 0;
+	uint32_t captureQueued = 0;
+	uint32_t lastInputLatencyMicros = 0;
+	uint32_t firstFrameMicros = 0;
+	uint32_t firstPresentMicros = 0;
+
+	// Per-second rates between an earlier snapshot and this one
+	double InstructionsPerSecond(const MetricsSnapshot& earlier) const;
+	double EmulatedFps(const MetricsSnapshot& earlier) const;
+	double PresentedFps(const MetricsSnapshot& earlier) const;
+	double UploadsPerSecond(const MetricsSnapshot& earlier) const;
+	double UiRenderMillis(const MetricsSnapshot& earlier) const; // average per presented frame
+	double InputLatencyMillis(const MetricsSnapshot& earlier) const; // average over the key presses measured
+
+	uint64_t FrameCount() const;
+};
+
+MetricsSnapshot Snapshot(const Metrics& metrics);
+
+enum class MetricsFormat : uint8_t
+{
+	Prometheus, // text exposition format, rewritten in place (for node_exporter's textfile collector)
+	JsonLines   // one JSON object appended per interval
+};
+
+// Writes a snapshot of a Metrics every interval from a background thread
+class MetricsExporter
+{
+public:
+	MetricsExporter() = default;
+	~MetricsExporter();
+
+	MetricsExporter(const MetricsExporter&) = delete;
+	MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+	bool Start(const Metrics& metrics, MetricsFormat format, const std::string& path, unsigned int intervalMs, std::string& error);
+
+	// Writes one last snapshot
+	void Stop();
+	bool IsActive() const { return thread.joinable(); }
+
+	// Formatting, also usable without the thread
+	static std::string FormatPrometheus(const MetricsSnapshot& now, const MetricsSnapshot& earlier);
+	static std::string FormatJson(const MetricsSnapshot& now, const MetricsSnapshot& earlier);
+
+private:
+	void Worker();
+	bool Write(const MetricsSnapshot& now, const MetricsSnapshot& earlier);
+
+	const Metrics* metrics = nullptr;
+	MetricsFormat format = MetricsFormat::Prometheus;
+	std::string path;
+	std::chrono::milliseconds interval{1000};
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
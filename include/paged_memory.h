@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "const.h"
+
+// The machine's 64KB address space as 256-byte pages, shared copy-on-write.
+// Copying a PagedMemory copies its page table and shares every page; a page is
+// copied only when one of its sharers writes to it. Pages nobody has written
+// are one all-zero page shared by everything, and ROM pages are shared with
+// the ROM image (see Chip8::LoadROM). So a thousand instances of one ROM hold
+// one copy of it plus the few pages each has written, and copying a machine
+// (snapshot, reset, forking a search branch) costs the page table, not 64KB.
+//
+// Reads are two loads and no branch. Writes check the page is this memory's
+// alone (one predictable branch) and copy it first if not. Reference counts
+// are atomic, so memories sharing pages can be copied, written and destroyed
+// on different threads; one PagedMemory is no more thread-safe than an array.
+class PagedMemory
+{
+public:
+	PagedMemory();
+	PagedMemory(const PagedMemory& other);
+	PagedMemory& operator=(const PagedMemory& other);
+	~PagedMemory();
+
+	uint8_t Read(uint32_t address) const
+	{
+		return pages[(address / MEMORY_PAGE_SIZE) % MEMORY_PAGE_COUNT][address % MEMORY_PAGE_SIZE];
+	}
+
+	void Write(uint32_t address, uint8_t value)
+	{
+		unsigned int page = (address / MEMORY_PAGE_SIZE) % MEMORY_PAGE_COUNT;
+		if (Refs(pages[page]).load(std::memory_order_acquire) != 1) Unshare(page);
+		pages[page][address % MEMORY_PAGE_SIZE] = value;
+	}
+
+	// Bytes [start, start + count) into `out`
+	void Copy(uint32_t start, uint8_t* out, size_t count) const;
+
+	// Make pages [first, first + count) the same pages as in `source`, where this memory's
+	// are still the zero page. Pages that have been written are left alone. Returns false if any were.
+	bool Share(const PagedMemory& source, unsigned int first, unsigned int count);
+
+	// The bytes of page `index`, and whether it's the shared zero page (never written)
+	const uint8_t* Page(unsigned int index) const { return pages[index]; }
+	bool IsZeroPage(unsigned int index) const { return pages[index] == ZeroPage(); }
+
+	// Pages this memory doesn't share with anything
+	unsigned int PrivatePages() const;
+
+private:
+	// A page is its reference count and MEMORY_PAGE_SIZE bytes, allocated together.
+	// The table points at the bytes; the count is HEADER_SIZE before them.
+	static const size_t HEADER_SIZE = 64;
+	static std::atomic<uint32_t>& Refs(uint8_t* bytes) { return *reinterpret_cast<std::atomic<uint32_t>*>(bytes - HEADER_SIZE); }
+
+	static uint8_t* ZeroPage();
+	static uint8_t* NewPage(const uint8_t* contents);
+	static void Retain(uint8_t* bytes);
+	static void Release(uint8_t* bytes);
+
+	// Give `page` its own copy before a write
+	void Unshare(unsigned int page);
+
+	uint8_t* pages[MEMORY_PAGE_COUNT];
+};
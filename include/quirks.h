@@ -0,0 +1,66 @@
+#ifndef CHIP8_QUIRKS_H
+#define CHIP8_QUIRKS_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Behaviour differences between CHIP-8 interpreters ("quirks").
+// Each variant is a policy type made of compile-time constants. Chip8::Run is
+// instantiated once per policy, so every quirk check folds away and each
+// variant gets its own branch-free interpreter loop.
+//
+// Reference: https://github.com/Timendus/chip8-test-suite#quirks-test
+
+// Original COSMAC VIP interpreter
+struct Chip8Quirks
+{
+	static constexpr bool shiftUsesVy     = true;  // 8XY6/8XYE shift VY into VX (otherwise shift VX in place)
+	static constexpr bool loadStoreBumpsI = true;  // FX55/FX65 leave I at I + X + 1 (otherwise I is unchanged)
+	static constexpr bool jumpUsesVx      = false; // BXNN jumps to XNN + VX (otherwise BNNN jumps to NNN + V0)
+	static constexpr bool clipSprites     = true;  // DXYN clips at the screen edges (otherwise wraps around)
+	static constexpr bool displayWait     = true;  // DXYN waits for the next 60Hz frame before continuing
+	static constexpr bool logicResetsVF   = true;  // 8XY1/8XY2/8XY3 reset VF to 0
+	static constexpr bool superChipOps    = false; // hi-res, scrolling, 16x16 sprites, big font, flag registers
+	static constexpr bool xoChipOps       = false; // bit planes, long I, save/load ranges, scroll up
+};
+
+// SUPER-CHIP 1.1 (HP48)
+struct SuperChipQuirks
+{
+	static constexpr bool shiftUsesVy     = false;
+	static constexpr bool loadStoreBumpsI = false;
+	static constexpr bool jumpUsesVx      = true;
+	static constexpr bool clipSprites     = true;
+	static constexpr bool displayWait     = false;
+	static constexpr bool logicResetsVF   = false;
+	static constexpr bool superChipOps    = true;
+	static constexpr bool xoChipOps       = false;
+};
+
+// XO-CHIP (Octo)
+struct XoChipQuirks
+{
+	static constexpr bool shiftUsesVy     = true;
+	static constexpr bool loadStoreBumpsI = true;
+	static constexpr bool jumpUsesVx      = false;
+	static constexpr bool clipSprites     = false;
+	static constexpr bool displayWait     = false;
+	static constexpr bool logicResetsVF   = false;
+	static constexpr bool superChipOps    = true;
+	static constexpr bool xoChipOps       = true;
+};
+
+// Runtime tag used to pick one of the pre-instantiated interpreters
+enum class Variant : uint8_t { Chip8, SuperChip, XoChip };
+const unsigned int VARIANT_COUNT = 3;
+
+const char* VariantName(Variant variant);
+
+// Short command-line name ("chip8", "schip", "xochip") to variant. Returns false if unknown.
+bool ParseVariant(const std::string& name, Variant& variant);
+
+// Guess the variant from a ROM image by looking for opcodes only the
+// extended interpreters have. Falls back to plain CHIP-8.
+Variant DetectVariant(const uint8_t* rom, size_t size);
+
+#endif // CHIP8_QUIRKS_H
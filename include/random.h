@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+// xorshift64* (Vigna): one 64-bit word of state and a multiply per number.
+// The state is a plain field of the machine, so it is copied with it (save
+// states, snapshots, other instances) and a given seed always produces the
+// same run, on any thread. There is no shared generator and no lock.
+struct Random
+{
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+
+	// Any seed is fine, including 0: it's mixed through splitmix64 first
+	void Seed(uint64_t seed)
+	{
+		uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		z ^= z >> 31;
+		state = z ? z : 0x9E3779B97F4A7C15ull; // all-zero state is the one fixed point
+	}
+
+	uint64_t Next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1Dull;
+	}
+
+	// The top bits are the strongest ones
+	uint8_t NextByte() { return static_cast<uint8_t>(Next() >> 56); }
+};
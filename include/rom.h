@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paged_memory.h"
+#include "quirks.h"
+
+// A ROM file read once, validated and hashed. Images are immutable once loaded,
+// so they can be shared freely between instances and threads; resets and batch
+// runs re-seed memory from one instead of going back to disk.
+struct RomImage
+{
+	std::string path;
+	std::vector<uint8_t> data;
+	PagedMemory memory;                 // `data` at 0x200, in pages Chip8::LoadROM shares
+	uint64_t hash = 0;                  // content hash (FNV-1a 64)
+	Variant variant = Variant::Chip8;   // best guess from the contents
+};
+
+// 64-bit FNV-1a over a byte range
+uint64_t HashRom(const uint8_t* data, size_t size);
+
+// Read and validate a ROM file. Returns nullptr and sets `error` on failure.
+std::shared_ptr<const RomImage> LoadRomImage(const std::string& path, std::string& error);
+
+// Loaded ROM images, keyed by path and by content hash. Two paths with the
+// same contents share one image. Safe to use from several threads.
+class RomCache
+{
+public:
+	// The cached image for `path`, reading it from disk on first use
+	std::shared_ptr<const RomImage> Get(const std::string& path, std::string& error);
+
+	// An already-loaded image with this content hash, or nullptr
+	std::shared_ptr<const RomImage> FindByHash(uint64_t hash) const;
+
+	// Drop `path` so the next Get reads it again (the file changed on disk)
+	void Evict(const std::string& path);
+
+private:
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const RomImage>> byPath;
+	std::unordered_map<uint64_t, std::shared_ptr<const RomImage>> byHash;
+};
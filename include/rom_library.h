@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "const.h"
+#include "quirks.h"
+
+struct RomImage;
+
+// What the library knows about one ROM file
+struct RomEntry
+{
+	std::string name;       // file name inside the library directory
+	int64_t mtime = 0;      // last write time, in the filesystem clock's ticks
+	uint64_t size = 0;
+	uint64_t hash = 0;      // content hash, same as RomImage::hash
+	Variant variant = Variant::Chip8;
+
+	// Screen after THUMBNAIL_FRAMES headless frames, all planes OR'd together
+	bool thumbnailHires = false;
+	uint64_t thumbnail[DISPLAY_HEIGHT][DISPLAY_ROW_WORDS]{};
+};
+
+// Frames run headless to capture a ROM's thumbnail, and instructions per frame
+const unsigned int THUMBNAIL_FRAMES = 120;
+const unsigned int THUMBNAIL_CYCLES_PER_FRAME = 12;
+
+// Background scanner for a directory of ROMs.
+// Scan() returns immediately; a worker thread lists the directory, reuses the
+// index entry for any file whose path, mtime and size are unchanged, and only
+// reads, hashes and test-runs the rest. Files that were merely touched (same
+// hash) or renamed keep their metadata. The index is saved next to the ROMs
+// so the next start only pays for what changed.
+class RomLibrary
+{
+public:
+	~RomLibrary();
+
+	// Start a (re)scan of `directory`, cancelling any scan in progress
+	void Scan(const std::string& directory);
+
+	// Copy the current list into `roms` if it changed since the last call. Never blocks on the scan.
+	bool Poll(std::vector<std::shared_ptr<const RomEntry>>& roms);
+
+	bool IsScanning() const { return scanning.load(std::memory_order_acquire); }
+
+	// Files processed / found by the scan in progress
+	unsigned int Progress() const { return progress.load(std::memory_order_relaxed); }
+	unsigned int Total() const { return total.load(std::memory_order_relaxed); }
+
+	// Name of the index file kept in the library directory
+	static constexpr const char* INDEX_FILE = ".chip8-index";
+
+private:
+	void Worker(std::string directory);
+	void Publish(const std::vector<std::shared_ptr<const RomEntry>>& roms);
+	void Stop();
+
+	static std::shared_ptr<RomEntry> Analyse(const RomImage& rom, const std::string& name, int64_t mtime);
+	static std::vector<std::shared_ptr<const RomEntry>> LoadIndex(const std::string& path);
+	static void SaveIndex(const std::string& path, const std::vector<std::shared_ptr<const RomEntry>>& roms);
+
+	std::thread thread;
+	std::atomic<bool> cancel{false};
+	std::atomic<bool> scanning{false};
+	std::atomic<unsigned int> progress{0};
+	std::atomic<unsigned int> total{0};
+
+	// Latest list handed from the worker to the UI
+	std::mutex mutex;
+	std::vector<std::shared_ptr<const RomEntry>> published;
+	uint32_t publishedGeneration = 0;
+	uint32_t polledGeneration = 0;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include "const.h"
+
+// How the display is turned into pixels: an integer scale (output pixels per
+// hi-res pixel; lo-res pixels are twice that) and the colour for each of the
+// 16 bit-plane combinations, as 0xAABBGGRR words like displayPalette.
+struct ScaleOptions
+{
+	unsigned int scale = 1;
+	uint32_t palette[16];
+
+	ScaleOptions() { std::copy(std::begin(displayPalette), std::end(displayPalette), palette); }
+
+	unsigned int Width() const { return DISPLAY_WIDTH * scale; }
+	unsigned int Height() const { return DISPLAY_HEIGHT * scale; }
+};
+
+// Expand the bit-packed display to Width() x Height() RGBA pixels at `out`,
+// rows `pitch` bytes apart. Lo-res frames come out the same size as hi-res
+// ones, so a mode switch never changes the image size. Each source row is
+// converted to colours with SIMD bit-to-mask expansion and a palette select
+// (AVX2 when the CPU has it, otherwise SSE2, plain C++ off x86), widened with
+// vector stores, and the widened row is copied down for the rest of the pixel.
+void ScaleDisplay(const uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS], bool hires, const ScaleOptions& options, uint32_t* out, size_t pitch);
+
+// The kernel ScaleDisplay picked on this CPU: "AVX2", "SSE2" or "scalar"
+const char* ScalerKernel();
+
+// Read comma-separated RRGGBB hex colours into palette[0], [1], ... (the rest
+// are left alone), e.g. "000000,33FF66" for green on black
+bool ParsePalette(const std::string& text, uint32_t palette[16], std::string& error);
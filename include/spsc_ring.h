@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size single-producer/single-consumer ring buffer.
+// One thread pushes and one thread pops, with no locks or allocation on
+// either side, so it's safe to use from an audio callback.
+// Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+	// Producer: copy up to `count` items in, returns how many fit
+	size_t Push(const T* items, size_t count)
+	{
+		size_t write = head.load(std::memory_order_relaxed);
+		size_t read = tail.load(std::memory_order_acquire);
+		size_t space = Capacity - (write - read);
+		if (count > space) count = space;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			buffer[(write + i) & (Capacity - 1)] = items[i];
+		}
+		head.store(write + count, std::memory_order_release);
+		return count;
+	}
+
+	// Consumer: copy up to `count` items out, returns how many were available
+	size_t Pop(T* items, size_t count)
+	{
+		size_t read = tail.load(std::memory_order_relaxed);
+		size_t write = head.load(std::memory_order_acquire);
+		size_t available = write - read;
+		if (count > available) count = available;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			items[i] = buffer[(read + i) & (Capacity - 1)];
+		}
+		tail.store(read + count, std::memory_order_release);
+		return count;
+	}
+
+	// Either side: items currently queued (a snapshot, may be stale immediately)
+	size_t Size() const
+	{
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+	}
+
+	static constexpr size_t capacity = Capacity;
+
+private:
+	// Keep the two indices on separate cache lines so producer and consumer don't false-share
+	alignas(64) std::atomic<size_t> head{0};
+	alignas(64) std::atomic<size_t> tail{0};
+	alignas(64) T buffer[Capacity];
+};
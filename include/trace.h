@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Timeline instrumentation.
+// A TraceZone times the scope it's declared in and records it into a ring
+// buffer belonging to the calling thread. A thread's buffer is allocated the
+// first time it records (or names itself) and after that recording never
+// locks or allocates: two clock reads and a few relaxed stores. The buffers
+// keep each thread's most recent events, overwriting the oldest, so tracing
+// can stay on while the program runs and a hitch can be exported after it
+// happened. Export writes Chrome trace-event JSON, which chrome://tracing and
+// the Perfetto UI open as a timeline with one track per thread.
+class Trace
+{
+public:
+	// Events kept per thread (a power of two)
+	static const size_t EVENTS_PER_THREAD = size_t(1) << 16;
+
+	// Off by default. While off, a zone costs one relaxed load.
+	static void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+	static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	// Nanoseconds since the trace started (program start-up)
+	static uint64_t Now();
+
+	// Record a zone on the calling thread. `name` must stay valid for the rest of the program (a string literal).
+	static void Record(const char* name, uint64_t start, uint64_t end);
+
+	// The calling thread's track name in exported traces; `name` as for Record
+	static void NameThread(const char* name);
+
+	// Everything still buffered, on every thread, as a trace-event JSON document
+	static std::string FormatJson();
+	static bool Export(const std::string& path, std::string& error);
+
+	// Events recorded so far, over all threads (including ones since overwritten)
+	static uint64_t Recorded();
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+// Times its own scope: declare one at the top of the block to measure
+class TraceZone
+{
+public:
+	explicit TraceZone(const char* name) : name(name), active(Trace::IsEnabled()), start(active ? Trace::Now() : 0) {}
+	~TraceZone()
+	{
+		if (active) Trace::Record(name, start, Trace::Now());
+	}
+
+	TraceZone(const TraceZone&) = delete;
+	TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+	const char* name;
+	bool active;
+	uint64_t start;
+};
@@ -0,0 +1,249 @@
+#include "analysis.h"
+#include "chip8.h"
+#include <cstdio>
+
+unsigned int ProgramAnalysis::InstructionLength(const uint8_t* memory, uint16_t address, Variant variant)
+{
+	return InstructionLength(static_cast<uint16_t>(memory[address % MEMORY_SIZE] << 8 | memory[(address + 1) % MEMORY_SIZE]), variant);
+}
+
+unsigned int ProgramAnalysis::InstructionLength(uint16_t opcode, Variant variant)
+{
+	return (variant == Variant::XoChip && opcode == 0xF000) ? 4 : 2;
+}
+
+const ProgramAnalysis::Block* ProgramAnalysis::BlockAt(uint16_t address) const
+{
+	auto it = blocks.find(address);
+	return it != blocks.end() ? &it->second : nullptr;
+}
+
+std::string ProgramAnalysis::Label(uint16_t address) const
+{
+	const Block* block = BlockAt(address);
+	if (!block) return "";
+
+	if (address == entryPoint) return "start";
+
+	char label[16];
+	const char* prefix = subroutines.count(address) ? "sub" : block->loopHeader ? "loop" : "L";
+	std::snprintf(label, sizeof(label), "%s_%03X", prefix, address);
+	return label;
+}
+
+void ProgramAnalysis::Analyse(const uint8_t* memory, Variant variant, uint16_t entry)
+{
+	kinds.assign(MEMORY_SIZE, UNKNOWN);
+	entryPoint = entry;
+	blocks.clear();
+	subroutines.clear();
+	loops = 0;
+
+	auto read = [&](uint32_t address) -> uint16_t { return memory[address % MEMORY_SIZE] << 8 | memory[(address + 1) % MEMORY_SIZE]; };
+
+	// Mark bytes read through I as data (never over code)
+	auto markData = [&](int32_t index, unsigned int length)
+	{
+		if (index < 0) return;
+		for (unsigned int i = 0; i < length && index + i < MEMORY_SIZE; ++i)
+		{
+			if (kinds[index + i] == UNKNOWN) kinds[index + i] = DATA;
+		}
+	};
+
+	// Pass 1: follow every path, marking instructions and collecting block leaders
+	std::set<uint16_t> leaders = { entry };
+	std::vector<uint16_t> worklist = { entry };
+	subroutines.insert(entry);
+
+	while (!worklist.empty())
+	{
+		uint32_t pc = worklist.back();
+		worklist.pop_back();
+
+		// Walk straight-line code, tracking I while it's a known constant
+		int32_t index = -1;
+		while (pc + 1 < MEMORY_SIZE && kinds[pc] != CODE)
+		{
+			uint16_t opcode = read(pc);
+			unsigned int length = InstructionLength(memory, pc, variant);
+
+			// Running into zeros or an undefined opcode means this path went into data
+			if (opcode == 0x0000 || Chip8::Disassemble(opcode).compare(0, 3, "UNK") == 0) break;
+
+			kinds[pc] = CODE;
+			for (unsigned int i = 1; i < length && pc + i < MEMORY_SIZE; ++i) kinds[pc + i] = OPERAND;
+			uint32_t next = pc + length;
+
+			uint8_t x = (opcode & 0x0F00) >> 8;
+			uint8_t n = opcode & 0x000F;
+			uint8_t nn = opcode & 0x00FF;
+			uint16_t nnn = opcode & 0x0FFF;
+			bool ends = false;
+
+			auto branchTo = [&](uint32_t target)
+			{
+				if (target + 1 >= MEMORY_SIZE) return;
+				leaders.insert(target);
+				worklist.push_back(target);
+			};
+
+			switch (opcode >> 12)
+			{
+				case 0x0:
+					if (opcode == 0x00EE || opcode == 0x00FD) ends = true; // return, exit
+					break;
+
+				case 0x1: // jump
+					branchTo(nnn);
+					ends = true;
+					break;
+
+				case 0x2: // call: the routine returns here, so carry on
+					subroutines.insert(nnn);
+					branchTo(nnn);
+					break;
+
+				case 0x3: case 0x4: case 0x5: case 0x9: case 0xE: // skips: both ways
+					if ((opcode >> 12) == 0xE && nn != 0x9E && nn != 0xA1) break;
+					if ((opcode >> 12) == 0x5 && n != 0) break; // XO-CHIP save/load, handled below
+					branchTo(next);
+					branchTo(next + InstructionLength(memory, next, variant));
+					ends = true;
+					break;
+
+				case 0xA:
+					index = nnn;
+					break;
+
+				case 0xB: // computed jump: can't follow
+					ends = true;
+					break;
+
+				case 0xD:
+				{
+					unsigned int rows = (n == 0 && variant != Variant::Chip8) ? 32 : n;
+					markData(index, rows);
+					break;
+				}
+
+				case 0xF:
+					if (opcode == 0xF000 && length == 4) index = read(pc + 2);
+					else if (nn == 0x02) markData(index, AUDIO_PATTERN_SIZE);
+					else if (nn == 0x55 || nn == 0x65) { markData(index, x + 1); index = -1; }
+					else if (nn == 0x1E || nn == 0x29 || nn == 0x30) index = -1; // I moved to an unknown address
+					break;
+			}
+
+			// XO-CHIP register range save/load
+			if ((opcode >> 12) == 0x5 && (n == 2 || n == 3))
+			{
+				uint8_t y = (opcode & 0x00F0) >> 4;
+				markData(index, (x > y ? x - y : y - x) + 1);
+			}
+
+			if (ends) break;
+			pc = next;
+			if (leaders.count(pc)) break; // someone else's block starts here; it gets walked from there
+		}
+	}
+
+	// Pass 2: cut the code into blocks at leaders and after control transfers
+	for (uint16_t leader : leaders)
+	{
+		if (kinds[leader] != CODE || blocks.count(leader)) continue;
+
+		Block block;
+		block.start = leader;
+		uint32_t pc = leader;
+		while (true)
+		{
+			uint16_t opcode = read(pc);
+			uint32_t next = pc + InstructionLength(memory, pc, variant);
+			uint8_t kind = opcode >> 12;
+			uint8_t nn = opcode & 0x00FF;
+			uint8_t n = opcode & 0x000F;
+
+			if (kind == 0x2) block.calls.push_back(opcode & 0x0FFF);
+
+			bool isSkip = kind == 0x3 || kind == 0x4 || ((kind == 0x5 || kind == 0x9) && n == 0) || (kind == 0xE && (nn == 0x9E || nn == 0xA1));
+			if (opcode == 0x00EE) { block.returns = true; block.end = next; break; }
+			if (opcode == 0x00FD) { block.end = next; break; }
+			if (kind == 0x1) { block.successors.push_back(opcode & 0x0FFF); block.end = next; break; }
+			if (kind == 0xB) { block.indirect = true; block.end = next; break; }
+			if (isSkip)
+			{
+				block.successors.push_back(next);
+				block.successors.push_back(next + InstructionLength(memory, next, variant));
+				block.end = next;
+				break;
+			}
+
+			// Falls into the next block, or off the end of the code we found
+			if (next + 1 >= MEMORY_SIZE || kinds[next] != CODE || leaders.count(next))
+			{
+				if (next + 1 < MEMORY_SIZE && kinds[next] == CODE) block.successors.push_back(next);
+				block.end = next;
+				break;
+			}
+			pc = next;
+		}
+		blocks[leader] = block;
+	}
+
+	// Pass 3: loops are the targets of back edges in a depth-first walk from each routine's entry
+	std::map<uint16_t, uint8_t> state; // 1: on the DFS stack, 2: finished
+	for (uint16_t root : subroutines)
+	{
+		if (!blocks.count(root) || state[root]) continue;
+
+		std::vector<std::pair<uint16_t, size_t>> stack = { { root, 0 } };
+		state[root] = 1;
+		while (!stack.empty())
+		{
+			uint16_t address = stack.back().first;
+			size_t& edge = stack.back().second;
+			const Block& block = blocks[address];
+
+			if (edge < block.successors.size())
+			{
+				uint16_t target = block.successors[edge++];
+				auto it = blocks.find(target);
+				if (it == blocks.end()) continue;
+
+				if (state[target] == 1)
+				{
+					if (!it->second.loopHeader) ++loops;
+					it->second.loopHeader = true;
+				}
+				else if (state[target] == 0)
+				{
+					state[target] = 1;
+					stack.push_back({ target, 0 });
+				}
+			}
+			else
+			{
+				state[address] = 2;
+				stack.pop_back();
+			}
+		}
+	}
+
+	// Pass 4: which routine each block belongs to (first claim wins for shared tails)
+	for (uint16_t routine : subroutines)
+	{
+		std::vector<uint16_t> pending = { routine };
+		std::set<uint16_t> seen;
+		while (!pending.empty())
+		{
+			uint16_t address = pending.back();
+			pending.pop_back();
+			auto it = blocks.find(address);
+			if (it == blocks.end() || !seen.insert(address).second) continue;
+			if (it->second.subroutine != 0 && address != routine) continue;
+			it->second.subroutine = routine;
+			for (uint16_t next : it->second.successors) pending.push_back(next);
+		}
+	}
+}
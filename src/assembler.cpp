@@ -0,0 +1,435 @@
+#include "assembler.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <sstream>
+
+namespace
+{
+	// An operand that may refer to a label defined later, patched in once everything is placed
+	struct Fixup
+	{
+		enum Kind { ADDRESS, WORD, BYTE };
+		size_t offset;      // of the instruction / data in the ROM
+		Kind kind;          // ADDRESS: low 12 bits of a word, WORD: a whole word, BYTE: low byte of a word, or one data byte
+		bool dataByte;      // BYTE fixup on a DB byte rather than an instruction
+		std::string expr;
+		unsigned int line;
+	};
+
+	std::string Trim(const std::string& text)
+	{
+		size_t start = text.find_first_not_of(" \t\r");
+		if (start == std::string::npos) return "";
+		size_t end = text.find_last_not_of(" \t\r");
+		return text.substr(start, end - start + 1);
+	}
+
+	std::string Upper(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::toupper(c); });
+		return text;
+	}
+
+	bool IsIdentifier(const std::string& text)
+	{
+		if (text.empty() || !(std::isalpha((unsigned char)text[0]) || text[0] == '_')) return false;
+		return std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isalnum(c) || c == '_'; });
+	}
+
+	bool ParseNumber(const std::string& text, long& value)
+	{
+		if (text.empty() || !std::isdigit((unsigned char)text[0])) return false;
+		try
+		{
+			size_t used = 0;
+			if (text.size() > 2 && text[0] == '0' && text[1] == 'X') value = std::stol(text.substr(2), &used, 16), used += 2;
+			else if (text.size() > 2 && text[0] == '0' && text[1] == 'B') value = std::stol(text.substr(2), &used, 2), used += 2;
+			else value = std::stol(text, &used, 10);
+			return used == text.size();
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+
+	// V0-VF -> 0-15, anything else -> -1
+	int ParseRegister(const std::string& text)
+	{
+		if (text.size() != 2 || text[0] != 'V' || !std::isxdigit((unsigned char)text[1])) return -1;
+		return std::stoi(text.substr(1), nullptr, 16);
+	}
+
+	// number | label, joined with + and -
+	bool Evaluate(const std::string& expr, const std::map<std::string, long>& labels, long& value, std::string& error)
+	{
+		value = 0;
+		size_t i = 0;
+		int sign = 1;
+		bool expectTerm = true;
+		while (i < expr.size())
+		{
+			char c = expr[i];
+			if (c == ' ' || c == '\t') { ++i; continue; }
+			if (c == '+' || c == '-')
+			{
+				if (!expectTerm) expectTerm = true, sign = 1;
+				if (c == '-') sign = -sign;
+				++i;
+				continue;
+			}
+
+			size_t end = i;
+			while (end < expr.size() && (std::isalnum((unsigned char)expr[end]) || expr[end] == '_')) ++end;
+			std::string term = expr.substr(i, end - i);
+			if (term.empty() || !expectTerm)
+			{
+				error = "bad expression '" + expr + "'";
+				return false;
+			}
+
+			long termValue = 0;
+			if (!ParseNumber(term, termValue))
+			{
+				auto label = labels.find(term);
+				if (label == labels.end())
+				{
+					error = "unknown label '" + term + "'";
+					return false;
+				}
+				termValue = label->second;
+			}
+			value += sign * termValue;
+			sign = 1;
+			expectTerm = false;
+			i = end;
+		}
+
+		if (expectTerm)
+		{
+			error = "missing value";
+			return false;
+		}
+		return true;
+	}
+}
+
+bool Assembler::Assemble(const std::string& source, std::vector<uint8_t>& rom, std::string& error)
+{
+	rom.clear();
+	std::map<std::string, long> labels;
+	std::vector<Fixup> fixups;
+
+	std::istringstream input(source);
+	std::string text;
+	unsigned int lineNumber = 0;
+
+	auto fail = [&](const std::string& message)
+	{
+		error = "line " + std::to_string(lineNumber) + ": " + message;
+		return false;
+	};
+
+	auto emitWord = [&](uint16_t word)
+	{
+		rom.push_back(word >> 8);
+		rom.push_back(word & 0xFF);
+	};
+
+	// Emit `word` with an operand patched in later
+	auto emitWith = [&](uint16_t word, Fixup::Kind kind, const std::string& expr)
+	{
+		fixups.push_back({ rom.size(), kind, false, expr, lineNumber });
+		emitWord(word);
+	};
+
+	while (std::getline(input, text))
+	{
+		++lineNumber;
+
+		// Comments and the disassembler's "(decimal)" annotations
+		size_t comment = text.find(';');
+		if (comment != std::string::npos) text.erase(comment);
+		for (size_t open; (open = text.find('(')) != std::string::npos; )
+		{
+			size_t close = text.find(')', open);
+			text.erase(open, close == std::string::npos ? std::string::npos : close - open + 1);
+		}
+		std::string line = Upper(Trim(text));
+
+		// Labels
+		for (size_t colon; (colon = line.find(':')) != std::string::npos; )
+		{
+			std::string label = Trim(line.substr(0, colon));
+			if (!IsIdentifier(label) || ParseRegister(label) >= 0) return fail("bad label '" + label + "'");
+			if (labels.count(label)) return fail("label '" + label + "' defined twice");
+			labels[label] = origin + rom.size();
+			line = Trim(line.substr(colon + 1));
+		}
+		if (line.empty()) continue;
+
+		// Mnemonic and comma-separated operands
+		size_t space = line.find_first_of(" \t");
+		std::string op = line.substr(0, space);
+		std::vector<std::string> args;
+		if (space != std::string::npos)
+		{
+			std::stringstream rest(line.substr(space + 1));
+			for (std::string arg; std::getline(rest, arg, ','); ) args.push_back(Trim(arg));
+		}
+
+		auto reg = [&](size_t i) { return i < args.size() ? ParseRegister(args[i]) : -1; };
+		auto is = [&](size_t i, const char* name) { return i < args.size() && args[i] == name; };
+
+		// A value known now (nibbles, ORG): no forward references
+		auto constant = [&](size_t i, long min, long max, long& value)
+		{
+			std::string message;
+			if (i >= args.size()) return fail(op + ": missing operand");
+			if (!Evaluate(args[i], labels, value, message)) return fail(message);
+			if (value < min || value > max) return fail(op + ": " + args[i] + " out of range");
+			return true;
+		};
+
+		uint16_t x = reg(0) >= 0 ? reg(0) << 8 : 0;
+		uint16_t y = reg(1) >= 0 ? reg(1) << 4 : 0;
+		size_t n = args.size();
+		long value = 0;
+
+		// Data
+		if (op == "DB" || op == "DW")
+		{
+			if (n == 0) return fail(op + ": missing operand");
+			for (const std::string& arg : args)
+			{
+				if (op == "DB")
+				{
+					fixups.push_back({ rom.size(), Fixup::BYTE, true, arg, lineNumber });
+					rom.push_back(0);
+				}
+				else
+				{
+					emitWith(0, Fixup::WORD, arg);
+				}
+			}
+		}
+		else if (op == "ORG")
+		{
+			if (!constant(0, origin + (long)rom.size(), 0xFFFF, value)) return false;
+			rom.resize(value - origin, 0);
+		}
+
+		// No operands
+		else if (n == 0 && op == "CLS")   emitWord(0x00E0);
+		else if (n == 0 && op == "RET")   emitWord(0x00EE);
+		else if (n == 0 && op == "SCR")   emitWord(0x00FB);
+		else if (n == 0 && op == "SCL")   emitWord(0x00FC);
+		else if (n == 0 && op == "EXIT")  emitWord(0x00FD);
+		else if (n == 0 && op == "LOW")   emitWord(0x00FE);
+		else if (n == 0 && op == "HIGH")  emitWord(0x00FF);
+		else if (n == 0 && op == "AUDIO") emitWord(0xF002);
+
+		// Scrolling, plane selection
+		else if (n == 1 && (op == "SCD" || op == "SCU"))
+		{
+			if (!constant(0, 0, 15, value)) return false;
+			emitWord((op == "SCD" ? 0x00C0 : 0x00D0) | value);
+		}
+		else if (n == 1 && op == "PLANE")
+		{
+			if (!constant(0, 0, 15, value)) return false;
+			emitWord(0xF001 | value << 8);
+		}
+
+		// Flow
+		else if (n == 1 && op == "SYS")  emitWith(0x0000, Fixup::ADDRESS, args[0]);
+		else if (n == 1 && op == "JP")   emitWith(0x1000, Fixup::ADDRESS, args[0]);
+		else if (n == 2 && op == "JP" && is(0, "V0")) emitWith(0xB000, Fixup::ADDRESS, args[1]);
+		else if (n == 1 && op == "CALL") emitWith(0x2000, Fixup::ADDRESS, args[0]);
+		else if (n == 1 && op == "UNK")  emitWith(0x0000, Fixup::WORD, args[0]);
+
+		// Skips
+		else if (n == 2 && (op == "SE" || op == "SNE") && reg(0) >= 0)
+		{
+			if (reg(1) >= 0) emitWord((op == "SE" ? 0x5000 : 0x9000) | x | y);
+			else emitWith((op == "SE" ? 0x3000 : 0x4000) | x, Fixup::BYTE, args[1]);
+		}
+		else if (n == 1 && op == "SKP"  && reg(0) >= 0) emitWord(0xE09E | x);
+		else if (n == 1 && op == "SKNP" && reg(0) >= 0) emitWord(0xE0A1 | x);
+
+		// XO-CHIP register ranges
+		else if (n == 2 && op == "SAVE" && reg(0) >= 0 && reg(1) >= 0) emitWord(0x5002 | x | y);
+		else if (n == 2 && op == "LOAD" && reg(0) >= 0 && reg(1) >= 0) emitWord(0x5003 | x | y);
+
+		// Loads
+		else if (n == 2 && op == "LD" && reg(0) >= 0)
+		{
+			if (reg(1) >= 0)          emitWord(0x8000 | x | y);
+			else if (is(1, "DT"))     emitWord(0xF007 | x);
+			else if (is(1, "K"))      emitWord(0xF00A | x);
+			else if (is(1, "[I]"))    emitWord(0xF065 | x);
+			else if (is(1, "R"))      emitWord(0xF085 | x);
+			else                      emitWith(0x6000 | x, Fixup::BYTE, args[1]);
+		}
+		else if (n == 2 && op == "LD" && is(0, "I"))
+		{
+			// "LD I, LONG" alone is how the disassembler shows F000; its address follows as the next word.
+			// LONG is a keyword of its own, so labels may still start with it.
+			std::string target = args[1];
+			size_t keywordEnd = target.find_first_of(" \t");
+			if (target.substr(0, keywordEnd) == "LONG")
+			{
+				emitWord(0xF000);
+				if (keywordEnd != std::string::npos) emitWith(0x0000, Fixup::WORD, Trim(target.substr(keywordEnd)));
+			}
+			else
+			{
+				emitWith(0xA000, Fixup::ADDRESS, target);
+			}
+		}
+		else if (n == 2 && op == "LD" && reg(1) >= 0)
+		{
+			uint16_t vx = reg(1) << 8;
+			if (is(0, "DT"))       emitWord(0xF015 | vx);
+			else if (is(0, "ST"))  emitWord(0xF018 | vx);
+			else if (is(0, "F"))   emitWord(0xF029 | vx);
+			else if (is(0, "HF"))  emitWord(0xF030 | vx);
+			else if (is(0, "B"))   emitWord(0xF033 | vx);
+			else if (is(0, "[I]")) emitWord(0xF055 | vx);
+			else if (is(0, "R"))   emitWord(0xF075 | vx);
+			else return fail("bad operands for LD");
+		}
+
+		// Arithmetic and logic
+		else if (n == 2 && op == "ADD" && is(0, "I") && reg(1) >= 0) emitWord(0xF01E | reg(1) << 8);
+		else if (n == 2 && op == "ADD" && reg(0) >= 0)
+		{
+			if (reg(1) >= 0) emitWord(0x8004 | x | y);
+			else emitWith(0x7000 | x, Fixup::BYTE, args[1]);
+		}
+		else if ((op == "OR" || op == "AND" || op == "XOR" || op == "SUB" || op == "SUBN") && n == 2 && reg(0) >= 0 && reg(1) >= 0)
+		{
+			uint16_t kind = op == "OR" ? 0x1 : op == "AND" ? 0x2 : op == "XOR" ? 0x3 : op == "SUB" ? 0x5 : 0x7;
+			emitWord(0x8000 | x | y | kind);
+		}
+		else if ((op == "SHR" || op == "SHL") && (n == 1 || n == 2) && reg(0) >= 0 && (n == 1 || reg(1) >= 0))
+		{
+			// One operand shifts VX by itself
+			uint16_t vy = n == 1 ? reg(0) << 4 : y;
+			emitWord(0x8000 | x | vy | (op == "SHR" ? 0x6 : 0xE));
+		}
+		else if (n == 2 && op == "RND" && reg(0) >= 0) emitWith(0xC000 | x, Fixup::BYTE, args[1]);
+		else if (n == 3 && op == "DRW" && reg(0) >= 0 && reg(1) >= 0)
+		{
+			if (!constant(2, 0, 15, value)) return false;
+			emitWord(0xD000 | x | y | value);
+		}
+
+		// Timers and sound
+		else if (n == 1 && op == "PITCH" && reg(0) >= 0) emitWord(0xF03A | x);
+
+		else return fail("unknown instruction '" + line + "'");
+
+		if (origin + rom.size() > 0x10000) return fail("program doesn't fit in memory");
+	}
+
+	// Now every label is known
+	for (const Fixup& fixup : fixups)
+	{
+		lineNumber = fixup.line;
+		std::string message;
+		long value = 0;
+		if (!Evaluate(fixup.expr, labels, value, message)) return fail(message);
+
+		switch (fixup.kind)
+		{
+			case Fixup::ADDRESS:
+				if (value < 0 || value > 0xFFF) return fail(fixup.expr + " is not a 12-bit address");
+				rom[fixup.offset] |= value >> 8;
+				rom[fixup.offset + 1] = value & 0xFF;
+				break;
+
+			case Fixup::WORD:
+				if (value < -0x8000 || value > 0xFFFF) return fail(fixup.expr + " doesn't fit in 16 bits");
+				rom[fixup.offset] = (value >> 8) & 0xFF;
+				rom[fixup.offset + 1] = value & 0xFF;
+				break;
+
+			case Fixup::BYTE:
+				if (value < -0x80 || value > 0xFF) return fail(fixup.expr + " doesn't fit in a byte");
+				rom[fixup.dataByte ? fixup.offset : fixup.offset + 1] = value & 0xFF;
+				break;
+		}
+	}
+
+	return true;
+}
+
+bool GenerateWorkload(const std::string& kind, unsigned int size, std::string& source)
+{
+	std::ostringstream out;
+
+	if (kind == "alu")
+	{
+		// Mix of every ALU op over V0-V7, cycling so no two neighbours are the same
+		static const char* ops[] = { "ADD V%X, V%X", "OR V%X, V%X", "AND V%X, V%X", "XOR V%X, V%X", "SUB V%X, V%X", "SUBN V%X, V%X", "SHR V%X, V%X", "SHL V%X, V%X", "ADD V%X, 0x%X" };
+		out << "loop:\n";
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			char line[32];
+			std::snprintf(line, sizeof(line), ops[i % 9], i % 8, (i * 3 + 1) % 8);
+			out << "\t" << line << "\n";
+		}
+		out << "\tJP loop\n";
+	}
+	else if (kind == "draw")
+	{
+		// Digits drawn across the screen, positions in V0/V1, moving each loop
+		out << "loop:\n";
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			out << "\tLD V2, 0x" << std::hex << (i & 0xF) << std::dec << "\n";
+			out << "\tLD F, V2\n";
+			out << "\tDRW V0, V1, 5\n";
+			out << "\tADD V0, 5\n";
+			out << "\tADD V1, 3\n";
+		}
+		out << "\tADD V0, 1\n";
+		out << "\tJP loop\n";
+	}
+	else if (kind == "call")
+	{
+		// Chain of subroutines, each calling the next
+		unsigned int depth = std::min(size, 15u);
+		out << "loop:\n\tCALL sub0\n\tJP loop\n";
+		for (unsigned int i = 0; i < depth; ++i)
+		{
+			out << "sub" << i << ":\n\tADD V" << std::hex << (i & 0xF) << std::dec << ", 1\n";
+			if (i + 1 < depth) out << "\tCALL sub" << i + 1 << "\n";
+			out << "\tRET\n";
+		}
+		if (depth == 0) out << "sub0:\n\tRET\n";
+	}
+	else if (kind == "smc")
+	{
+		// Store V0 over the immediate of "patched" (an ADD V1, NN) and run it, `size` times per loop
+		out << "loop:\n";
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			out << "\tADD V0, 1\n";
+			out << "\tLD I, patched + 1\n";
+			out << "\tLD [I], V0\n";
+			out << "\tCALL patched\n";
+		}
+		out << "\tJP loop\n";
+		out << "patched:\n\tADD V1, 0\n\tRET\n";
+	}
+	else
+	{
+		return false;
+	}
+
+	source = out.str();
+	return true;
+}
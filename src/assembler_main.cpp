@@ -0,0 +1,67 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "assembler.h"
+
+// Command-line front end for the assembler:
+//   chip8_asm <source> <output ROM>
+//   chip8_asm --workload <alu|draw|call|smc> <size> <output ROM> [source output]
+
+static void PrintUsage(const char* program)
+{
+	std::cout << "Usage: " << program << " <source file> <output ROM>" << std::endl;
+	std::cout << "   or: " << program << " --workload <alu|draw|call|smc> <size> <output ROM> [source output]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string source;
+	std::string outputPath;
+	std::string sourceOutputPath;
+
+	if (argc >= 5 && std::string(argv[1]) == "--workload") {
+		if (!GenerateWorkload(argv[2], std::stoul(argv[3]), source)) {
+			std::cout << "Unknown workload: " << argv[2] << std::endl;
+			return 1;
+		}
+		outputPath = argv[4];
+		if (argc >= 6) sourceOutputPath = argv[5];
+	} else if (argc == 3) {
+		std::ifstream file(argv[1]);
+		if (!file) {
+			std::cout << "Failed to open source: " << argv[1] << std::endl;
+			return 1;
+		}
+		std::stringstream text;
+		text << file.rdbuf();
+		source = text.str();
+		outputPath = argv[2];
+	} else {
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	Assembler assembler;
+	std::vector<uint8_t> rom;
+	std::string error;
+	if (!assembler.Assemble(source, rom, error)) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+
+	std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+	output.write(reinterpret_cast<const char*>(rom.data()), rom.size());
+	if (!output) {
+		std::cout << "Failed to write ROM: " << outputPath << std::endl;
+		return 1;
+	}
+
+	if (!sourceOutputPath.empty()) {
+		std::ofstream sourceOutput(sourceOutputPath, std::ios::trunc);
+		sourceOutput << source;
+	}
+
+	std::cout << "Wrote " << rom.size() << " bytes to " << outputPath << std::endl;
+	return 0;
+}
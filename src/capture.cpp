@@ -0,0 +1,268 @@
+#include "capture.h"
+#include "chip8.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <csignal>
+#endif
+
+// PNG ************************************************************************
+// Minimal writer: 8-bit RGBA straight from the scaler, stored (uncompressed)
+// deflate blocks. Lossless and needs no zlib.
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+	// Built once, thread-safely: screenshots and the encoder thread can both get here
+	static const std::array<uint32_t, 256> table = []
+	{
+		std::array<uint32_t, 256> t{};
+		for (uint32_t n = 0; n < 256; ++n)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			t[n] = c;
+		}
+		return t;
+	}();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void PutBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back(value >> 24);
+	out.push_back((value >> 16) & 0xFF);
+	out.push_back((value >> 8) & 0xFF);
+	out.push_back(value & 0xFF);
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char type[4], const std::vector<uint8_t>& data)
+{
+	PutBigEndian(out, static_cast<uint32_t>(data.size()));
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+	PutBigEndian(out, Crc32(&out[start], out.size() - start));
+}
+
+bool FrameCapture::WritePng(const std::string& path, const uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS], bool hires, const ScaleOptions& options)
+{
+	std::vector<uint32_t> pixels(options.Width() * options.Height());
+	ScaleDisplay(display, hires, options, pixels.data(), options.Width() * sizeof(uint32_t));
+	return WritePng(path, pixels.data(), options.Width(), options.Height());
+}
+
+bool FrameCapture::WritePng(const std::string& path, const uint32_t* pixels, unsigned int width, unsigned int height)
+{
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<uint8_t> png(signature, signature + sizeof(signature));
+
+	// Header: width, height, bit depth 8, colour type 6 (RGBA)
+	std::vector<uint8_t> header;
+	PutBigEndian(header, width);
+	PutBigEndian(header, height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+	PutChunk(png, "IHDR", header);
+
+	// Scanlines with filter type 0, in a zlib stream of stored blocks
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(pixels);
+	size_t rowBytes = width * sizeof(uint32_t);
+	std::vector<uint8_t> raw;
+	raw.reserve((rowBytes + 1) * height);
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), bytes + y * rowBytes, bytes + (y + 1) * rowBytes);
+	}
+
+	std::vector<uint8_t> zlib = { 0x78, 0x01 };
+	for (size_t offset = 0; offset < raw.size(); offset += 0xFFFF)
+	{
+		uint16_t length = static_cast<uint16_t>(std::min<size_t>(raw.size() - offset, 0xFFFF));
+		bool last = offset + length == raw.size();
+		zlib.insert(zlib.end(), { uint8_t(last ? 1 : 0), uint8_t(length & 0xFF), uint8_t(length >> 8), uint8_t(~length & 0xFF), uint8_t((~length >> 8) & 0xFF) });
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+	}
+	uint32_t a = 1, b = 0;
+	for (uint8_t byte : raw)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	PutBigEndian(zlib, (b << 16) | a);
+	PutChunk(png, "IDAT", zlib);
+	PutChunk(png, "IEND", {});
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(png.data()), png.size());
+	return static_cast<bool>(file);
+}
+
+// Capture ********************************************************************
+
+FrameCapture::FrameCapture() : pool(new Frame[POOL_SIZE])
+{
+	for (unsigned int i = 0; i < POOL_SIZE; ++i)
+	{
+		Frame* frame = &pool[i];
+		freeFrames.Push(&frame, 1);
+	}
+}
+
+FrameCapture::~FrameCapture()
+{
+	Stop();
+}
+
+bool FrameCapture::Start(CaptureFormat newFormat, const std::string& newTarget, const ScaleOptions& newOptions, std::string& error)
+{
+	Stop();
+
+	if (newFormat == CaptureFormat::Pipe)
+	{
+#ifndef _WIN32
+		// If the encoder exits early, writes should fail rather than kill the emulator
+		std::signal(SIGPIPE, SIG_IGN);
+#endif
+		pipe = popen(newTarget.c_str(), "w");
+		if (!pipe)
+		{
+			error = "Failed to start capture command: " + newTarget;
+			return false;
+		}
+	}
+	else
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(newTarget, ec);
+		if (ec)
+		{
+			error = "Failed to create capture directory " + newTarget + ": " + ec.message();
+			return false;
+		}
+	}
+
+	format = newFormat;
+	target = newTarget;
+	options = newOptions;
+	pixels.assign(options.Width() * options.Height(), 0);
+	captured = 0;
+	written = 0;
+	dropped = 0;
+	stopping = false;
+	active = true;
+	thread = std::thread(&FrameCapture::Worker, this);
+	return true;
+}
+
+void FrameCapture::Stop()
+{
+	if (!active) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	thread.join();
+	active = false;
+
+	if (pipe)
+	{
+		pclose(pipe);
+		pipe = nullptr;
+	}
+}
+
+void FrameCapture::Submit(const Chip8& chip8, bool wait)
+{
+	if (!active) return;
+
+	Frame* frame = nullptr;
+	if (freeFrames.Pop(&frame, 1) == 0)
+	{
+		if (!wait)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [this] { return freeFrames.Size() > 0; });
+		lock.unlock();
+		freeFrames.Pop(&frame, 1);
+	}
+
+	std::memcpy(frame->display, chip8.display, sizeof(frame->display));
+	frame->hires = chip8.hires;
+	frame->number = captured.fetch_add(1, std::memory_order_relaxed);
+	queued.Push(&frame, 1);
+
+	// The lock orders this against the encoder checking the queue before it sleeps
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+	wake.notify_all();
+}
+
+void FrameCapture::Worker()
+{
+	Trace::NameThread("Capture encoder");
+	for (;;)
+	{
+		Frame* frame = nullptr;
+		if (queued.Pop(&frame, 1) == 0)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return queued.Size() > 0 || stopping.load(); });
+			if (queued.Size() == 0) break; // stopping, and everything is written
+			continue;
+		}
+
+		{
+			TraceZone zone("FrameCapture::Encode");
+			if (Encode(*frame)) written.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		freeFrames.Push(&frame, 1);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+		}
+		wake.notify_all();
+	}
+}
+
+bool FrameCapture::Encode(const Frame& frame)
+{
+	char name[32];
+
+	ScaleDisplay(frame.display, frame.hires, options, pixels.data(), options.Width() * sizeof(uint32_t));
+	size_t size = pixels.size() * sizeof(uint32_t);
+
+	if (format == CaptureFormat::Png)
+	{
+		std::snprintf(name, sizeof(name), "/frame_%06llu.png", (unsigned long long)frame.number);
+		return WritePng(target + name, pixels.data(), options.Width(), options.Height());
+	}
+
+	if (format == CaptureFormat::Pipe)
+	{
+		return std::fwrite(pixels.data(), size, 1, pipe) == 1;
+	}
+
+	std::snprintf(name, sizeof(name), "/frame_%06llu.rgba", (unsigned long long)frame.number);
+	std::ofstream file(target + name, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(pixels.data()), size);
+	return static_cast<bool>(file);
+}
@@ -1,70 +1,465 @@
 #include "chip8.h"
-#include <fstream>
+#include "debugger.h"
+#include "instructions_impl.h"
+#include "quirks.h"
+#include "rom.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <algorithm>
 
-Chip8::Chip8()
+// SUPER-CHIP big font: 16 characters, 10 bytes per character (8x10)
+static const uint8_t bigFont[BIG_FONT_SIZE] =
+{
+	0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, // 0
+	0x18, 0x38, 0x58, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3C, // 1
+	0x3E, 0x7F, 0xC3, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFF, 0xFF, // 2
+	0x3C, 0x7E, 0xC3, 0x03, 0x0E, 0x0E, 0x03, 0xC3, 0x7E, 0x3C, // 3
+	0x06, 0x0E, 0x1E, 0x36, 0x66, 0xC6, 0xFF, 0xFF, 0x06, 0x06, // 4
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFE, 0x03, 0xC3, 0x7E, 0x3C, // 5
+	0x3E, 0x7C, 0xE0, 0xC0, 0xFC, 0xFE, 0xC3, 0xC3, 0x7E, 0x3C, // 6
+	0xFF, 0xFF, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, // 7
+	0x3C, 0x7E, 0xC3, 0xC3, 0x7E, 0x7E, 0xC3, 0xC3, 0x7E, 0x3C, // 8
+	0x3C, 0x7E, 0xC3, 0xC3, 0x7F, 0x3F, 0x03, 0x03, 0x3E, 0x7C, // 9
+	0x18, 0x3C, 0x66, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+	0xFC, 0xFE, 0xC3, 0xC3, 0xFE, 0xFE, 0xC3, 0xC3, 0xFE, 0xFC, // B
+	0x3C, 0x7E, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0x7E, 0x3C, // C
+	0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xFF, 0xFF, // E
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+// The fonts, in pages every machine shares
+static const PagedMemory& FontMemory()
 {
-    // Initialize PC
-    pc = PC_START_ADDRESS;
+	static const PagedMemory fonts = []
+	{
+		PagedMemory memory;
+		for (unsigned int i = 0; i < FONT_SIZE; ++i)
+		{
+			memory.Write(FONT_START_ADDRESS + i, font[i]);
+		}
+
+		// And the SUPER-CHIP big font right after it
+		for (unsigned int i = 0; i < BIG_FONT_SIZE; ++i)
+		{
+			memory.Write(BIG_FONT_START_ADDRESS + i, bigFont[i]);
+		}
+		return memory;
+	}();
+	return fonts;
+}
 
+Chip8::Chip8()
+{
 	// Load font data into memory
-	for (unsigned int i = 0; i < FONT_SIZE; ++i)
+	memory = FontMemory();
+
+#ifdef CHIP8_STATE_HASH
+	// Only the fonts are non-zero
+	static const uint64_t fontHash = []
 	{
-		memory[FONT_START_ADDRESS + i] = font[i];
-	}
+		uint64_t hash = 0;
+		for (uint32_t address = FONT_START_ADDRESS; address < BIG_FONT_START_ADDRESS + BIG_FONT_SIZE; ++address)
+		{
+			hash ^= PositionHash(address, FontMemory().Read(address));
+		}
+		return hash;
+	}();
+	memoryHash = fontHash;
+#endif
 }
 
-// Load Rom -> https://austinmorlan.com/posts/chip8_emulator/
-void Chip8::LoadROM(char const* filename)
+void Chip8::Reset()
 {
-	// Open the file as a stream of binary and move the file pointer to the end
-	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	// Built on first use, then every reset is a copy of it (the memory's page table, not its bytes)
+	static const Chip8 powerOn;
+	*this = powerOn;
+}
 
-	// Make sure the file exists
-	if (!file)
+// Load Rom -> https://austinmorlan.com/posts/chip8_emulator/
+// The image has already been read and validated by the ROM cache, so this is just a copy
+void Chip8::LoadROM(const RomImage& rom)
+{
+	// Load the ROM contents into the Chip8's memory, starting at 0x200
+#ifdef CHIP8_STATE_HASH
+	for (size_t i = 0; i < rom.data.size(); ++i)
 	{
-		std::cout << "Failed to open ROM: " << filename << std::endl;
-		exit(1);
+		uint32_t address = PC_START_ADDRESS + static_cast<uint32_t>(i);
+		memoryHash ^= PositionHash(address, memory.Read(address)) ^ PositionHash(address, rom.data[i]);
 	}
+#endif
+	// Share the image's pages, which is all of them after a reset. Pages this
+	// machine has written (reloading over a running program) get the bytes instead.
+	unsigned int firstPage = PC_START_ADDRESS / MEMORY_PAGE_SIZE;
+	unsigned int pageCount = static_cast<unsigned int>((rom.data.size() + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE);
+	if (!memory.Share(rom.memory, firstPage, pageCount))
+	{
+		for (size_t i = 0; i < rom.data.size(); ++i)
+		{
+			uint32_t address = PC_START_ADDRESS + static_cast<uint32_t>(i);
+			if (memory.Read(address) != rom.data[i]) memory.Write(address, rom.data[i]);
+		}
+	}
+
+	// Pick the interpreter quirks this ROM most likely expects
+	variant = rom.variant;
+}
+
+void Chip8::Cycle()
+{
+	Run<false>(1);
+}
+
+void Chip8::TickTimers()
+{
+	if (delayTimer > 0) delayTimer--;
+	if (soundTimer > 0) soundTimer--;
+
+	// Display wait quirk: DXYN is done once the frame has been drawn
+	waitingForVBlank = false;
+
+	// The timers changed, so an idle loop polling them may now make progress.
+	// Forget the probe too: the next idle verdict needs a whole loop iteration with the new inputs.
+	idle = false;
+	idleProbeJump = 0xFFFF;
+}
 
-	if (file.is_open())
+void Chip8::SetKey(uint8_t key, bool pressed)
+{
+	uint16_t bit = 1 << (key & 0xF);
+	keypad = pressed ? (keypad | bit) : (keypad & ~bit);
+	idle = false;
+	idleProbeJump = 0xFFFF;
+}
+
+// Multiply-xor over 64-bit words, four independent lanes so the multiplies overlap.
+// `size` is a multiple of 32 bytes.
+static uint64_t HashWords(uint64_t seed, const void* data, size_t size)
+{
+	const uint64_t prime = 0x9E3779B97F4A7C15ull;
+	uint64_t lanes[4] = { seed, seed ^ 1, seed ^ 2, seed ^ 3 };
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t offset = 0; offset < size; offset += 32)
 	{
-		// Get size of file and allocate a buffer to hold the contents
-		std::streampos size = file.tellg();
-		char* buffer = new char[size];
+		for (unsigned int lane = 0; lane < 4; ++lane)
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + offset + lane * 8, sizeof(word));
+			lanes[lane] = (lanes[lane] ^ word) * prime;
+			lanes[lane] ^= lanes[lane] >> 29;
+		}
+	}
 
-		// Go back to the beginning of the file and fill the buffer
-		file.seekg(0, std::ios::beg);
-		file.read(buffer, size);
-		file.close();
+	uint64_t hash = seed;
+	for (uint64_t lane : lanes) hash = (hash ^ lane) * prime;
+	return hash ^ (hash >> 32);
+}
 
-		// Load the ROM contents into the Chip8's memory, starting at 0x200
-		for (long i = 0; i < size; ++i)
+void Chip8::RehashState()
+{
+#ifdef CHIP8_STATE_HASH
+	memoryHash = 0;
+	for (unsigned int page = 0; page < MEMORY_PAGE_COUNT; ++page)
+	{
+		if (memory.IsZeroPage(page)) continue;
+		const uint8_t* bytes = memory.Page(page);
+		for (uint32_t offset = 0; offset < MEMORY_PAGE_SIZE; ++offset)
 		{
-			memory[PC_START_ADDRESS + i] = buffer[i];
+			if (bytes[offset]) memoryHash ^= PositionHash(page * MEMORY_PAGE_SIZE + offset, bytes[offset]);
 		}
+	}
+	RehashDisplay(0xF);
+#endif
+}
 
-		// Free the buffer
-		delete[] buffer;
+void Chip8::RehashDisplay([[maybe_unused]] uint8_t planes)
+{
+#ifdef CHIP8_STATE_HASH
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planes & (1 << plane))) continue;
+		displayHash[plane] = 0;
+		for (unsigned int row = 0; row < DISPLAY_HEIGHT; ++row)
+		{
+			for (unsigned int word = 0; word < DISPLAY_ROW_WORDS; ++word)
+			{
+				if (display[plane][row][word]) displayHash[plane] ^= PositionHash(DisplayPosition(plane, row, word), display[plane][row][word]);
+			}
+		}
 	}
+#endif
 }
 
-void Chip8::Cycle()
+uint64_t Chip8::StateHash() const
+{
+	// The small fields, gathered into whole words
+	alignas(8) uint8_t cpu[128]{};
+	std::memcpy(cpu, registers, sizeof(registers));
+	std::memcpy(cpu + 16, stack, sizeof(stack));
+	std::memcpy(cpu + 48, flagRegisters, sizeof(flagRegisters));
+	std::memcpy(cpu + 64, audioPattern, sizeof(audioPattern));
+	std::memcpy(cpu + 80, &random.state, sizeof(random.state));
+	uint64_t word = static_cast<uint64_t>(pc) | static_cast<uint64_t>(index) << 16 | static_cast<uint64_t>(sp) << 32
+		| static_cast<uint64_t>(delayTimer) << 40 | static_cast<uint64_t>(soundTimer) << 48 | static_cast<uint64_t>(audioPitch) << 56;
+	std::memcpy(cpu + 88, &word, sizeof(word));
+	uint64_t seed = static_cast<uint64_t>(variant) << 24 | planeMask << 16 | hires << 2 | waitingForVBlank << 1 | halted;
+
+#ifdef CHIP8_STATE_HASH
+	std::memcpy(cpu + 96, &memoryHash, sizeof(memoryHash));
+	uint64_t displayAll = displayHash[0] ^ displayHash[1] ^ displayHash[2] ^ displayHash[3];
+	std::memcpy(cpu + 104, &displayAll, sizeof(displayAll));
+	return HashWords(seed, cpu, sizeof(cpu));
+#else
+	uint64_t hash = HashWords(seed, cpu, sizeof(cpu));
+	hash = HashWords(hash, display, sizeof(display));
+	unsigned int pages = (variant == Variant::XoChip ? MEMORY_SIZE : 0x1000) / MEMORY_PAGE_SIZE;
+	for (unsigned int page = 0; page < pages; ++page) hash = HashWords(hash, memory.Page(page), MEMORY_PAGE_SIZE);
+	return hash;
+#endif
+}
+
+void Chip8::CheckIdleLoop(uint16_t jumpAddress, uint64_t executed)
+{
+	LoopState state{};
+	std::memcpy(state.registers, registers, sizeof(registers));
+	std::memcpy(state.stack, stack, sizeof(stack));
+	state.index = index;
+	state.sp = sp;
+	state.delayTimer = delayTimer;
+	state.soundTimer = soundTimer;
+	state.planeMask = planeMask;
+	state.hires = hires;
+	state.random = random.state;
+
+	// Same jump, same state, nothing written since: every further iteration is
+	// identical until a timer or key changes, so there's nothing to execute
+	if (jumpAddress == idleProbeJump && writeCount == idleProbeWrites &&
+		std::memcmp(&state, &idleProbe, sizeof(LoopState)) == 0)
+	{
+		idle = true;
+		return;
+	}
+
+	idleProbe = state;
+	idleProbeJump = jumpAddress;
+	idleProbeWrites = writeCount;
+	idleProbeCycles = machineCycles;
+	idleProbeInstructions = instructionCount + executed;
+}
+
+template <bool Debug>
+int Chip8::Run(int cycles, Debugger* debugger)
+{
+	// Pick the interpreter for this ROM's variant once per call, not per instruction
+	switch (variant)
+	{
+		case Variant::SuperChip: return RunVariant<SuperChipQuirks, Debug, false>(cycles, debugger);
+		case Variant::XoChip:    return RunVariant<XoChipQuirks, Debug, false>(cycles, debugger);
+		case Variant::Chip8:
+		default:                 return RunVariant<Chip8Quirks, Debug, false>(cycles, debugger);
+	}
+}
+
+template <bool Debug>
+int Chip8::RunTimed(uint64_t targetCycle, Debugger* debugger)
+{
+	switch (variant)
+	{
+		case Variant::SuperChip: return RunVariant<SuperChipQuirks, Debug, true>(targetCycle, debugger);
+		case Variant::XoChip:    return RunVariant<XoChipQuirks, Debug, true>(targetCycle, debugger);
+		case Variant::Chip8:
+		default:                 return RunVariant<Chip8Quirks, Debug, true>(targetCycle, debugger);
+	}
+}
+
+// Costs in 1802 machine cycles of the VIP interpreter's routines, on top of the
+// fetch/decode loop. Data-dependent ones (sprite shifts and height, BCD digits,
+// register counts) use the registers as they are before the instruction runs.
+// SUPER-CHIP/XO-CHIP instructions never ran on a VIP and cost the same as 6XNN.
+uint32_t Chip8::VipCycles(uint16_t opcode) const
+{
+	uint8_t x = (opcode >> 8) & 0xF;
+	uint8_t n = opcode & 0xF;
+	uint32_t cost = 6;
+
+	switch (opcode >> 12)
+	{
+		case 0x0:
+			if (opcode == 0x00E0) cost = 3038;      // clears the 256-byte display page a byte at a time
+			else if (opcode == 0x00EE) cost = 10;
+			break;
+		case 0x1: cost = 12; break;
+		case 0x2: cost = 26; break;
+		case 0x3: case 0x4: cost = 10; break;
+		case 0x5: case 0x9: cost = 14; break;
+		case 0x6: cost = 6; break;
+		case 0x7: cost = 10; break;
+		case 0x8: cost = n == 0x0 ? 12 : 44; break;
+		case 0xA: cost = 12; break;
+		case 0xB: cost = 22; break;
+		case 0xC: cost = 36; break;
+		case 0xD:
+		{
+			// Each sprite row is shifted into place a bit at a time, then XORed into two display bytes
+			uint32_t rows = n ? n : 32; // 16x16 sprites are 16 rows of 2 bytes
+			cost = 26 + rows * (34 + 8 * (registers[x] & 7));
+			break;
+		}
+		case 0xE: cost = 14; break;
+		case 0xF:
+			switch (opcode & 0xFF)
+			{
+				case 0x1E: case 0x29: cost = 16; break;
+				case 0x33:
+				{
+					// Digits are found by repeated subtraction
+					uint8_t value = registers[x];
+					cost = 80 + 16 * (value / 100 + value / 10 % 10 + value % 10);
+					break;
+				}
+				case 0x55: case 0x65: cost = 14 + 14 * (x + 1); break;
+				default: cost = 10; break;
+			}
+			break;
+	}
+	return VIP_FETCH_CYCLES + cost;
+}
+
+void Chip8::VipInterrupt()
 {
-	// Fetch: the instruction from memory at the current PC
-	// An instruction is two bytes, so you will need to read two successive bytes from memory and combine them into one 16-bit instruction.
-	uint16_t opcode = memory[pc] << 8 | memory[pc + 1];
-	pc += 2;
+	TickTimers();
+
+	// The video DMA and the interrupt routine take their share of the frame
+	machineCycles += VIP_INTERRUPT_CYCLES;
+	nextInterrupt += VIP_CYCLES_PER_FRAME;
+}
+
+template <typename Quirks, bool Debug, bool Timed>
+int Chip8::RunVariant(uint64_t limit, Debugger* debugger)
+{
+	int executed = 0;
+	for (;;)
+	{
+		if constexpr (Timed)
+		{
+			// The interrupt fires on its cycle, between instructions
+			while (machineCycles >= nextInterrupt) VipInterrupt();
+			if (machineCycles >= limit) break;
+
+			// Nothing runs until the interrupt; on the VIP that time just passes
+			if (halted)
+			{
+				machineCycles = limit;
+				break;
+			}
+			if (waitingForVBlank)
+			{
+				machineCycles = std::min<uint64_t>(nextInterrupt, limit);
+				continue;
+			}
+
+			// A polling loop repeats exactly until the interrupt (or a key change at
+			// `limit`), so skip its whole iterations and run the last partial one for real.
+			// FX0A with no key down repeats itself.
+			if (idle)
+			{
+				bool keyWait = !keypad && (Read(pc) & 0xF0) == 0xF0 && Read(pc + 1) == 0x0A;
+				uint64_t period = keyWait ? VipCycles(0xF00A) : machineCycles - idleProbeCycles;
+				uint64_t until = std::min<uint64_t>(nextInterrupt, limit);
+				if (period) machineCycles += (until - machineCycles) / period * period;
+				idle = false;
+				idleProbeJump = 0xFFFF;
+				if (machineCycles >= limit) break;
+			}
+		}
+		else
+		{
+			if (static_cast<uint64_t>(executed) >= limit) break;
+
+			// A polling loop repeats exactly until a timer tick or key change, which
+			// only come between calls, so skip its whole iterations in the budget and
+			// run the last partial one for real. FX0A with no key down repeats itself.
+			if (idle)
+			{
+				bool keyWait = !keypad && (Read(pc) & 0xF0) == 0xF0 && Read(pc + 1) == 0x0A;
+				uint64_t period = keyWait ? 1 : instructionCount + executed - idleProbeInstructions;
+				uint64_t remaining = limit - executed;
+				if (period) executed += static_cast<int>(remaining / period * period);
+				idle = false;
+				idleProbeJump = 0xFFFF;
+				if (static_cast<uint64_t>(executed) >= limit) break;
+			}
+
+			// Nothing runs until the next frame once DXYN has asked to wait
+			if constexpr (Quirks::displayWait)
+			{
+				if (waitingForVBlank) break;
+			}
+
+			// 00FD stops the interpreter for good
+			if constexpr (Quirks::superChipOps)
+			{
+				if (halted) break;
+			}
+		}
+
+		// Compiled out of the non-debug loop entirely
+		if constexpr (Debug)
+		{
+			if (debugger && debugger->Check(*this)) break;
+		}
+
+		// Fetch: the instruction from memory at the current PC
+		// An instruction is two bytes, so you will need to read two successive bytes from memory and combine them into one 16-bit instruction.
+		uint16_t address = pc;
+		uint16_t opcode = Read(pc) << 8 | Read(pc + 1);
+		pc += 2;
+
+		uint32_t cost = 0;
+		if constexpr (Timed)
+		{
+			cost = VipCycles(opcode);
+		}
+
+		Execute<Quirks>(opcode);
+		++executed;
 
-	DecodeAndExecute(opcode);
+		if constexpr (Timed)
+		{
+			uint8_t group = opcode >> 12;
+			bool skipOp = group == 0x3 || group == 0x4 || group == 0x5 || group == 0x9 || group == 0xE;
+			if (skipOp && pc != address + 2) cost += VIP_SKIP_CYCLES;
+
+			// The VIP's DXYN waits for the interrupt first and draws after it
+			if (waitingForVBlank)
+			{
+				machineCycles = nextInterrupt;
+				VipInterrupt();
+			}
+			machineCycles += cost;
+		}
+
+		// Polling loops close with a backward jump. Skipped on the debug path so
+		// breakpoints inside a polling loop still hit.
+		if constexpr (!Debug)
+		{
+			if ((opcode & 0xF000) == 0x1000 && pc <= address) CheckIdleLoop(address, executed);
+		}
+	}
+	instructionCount += executed;
+	return executed;
 }
 
+template int Chip8::Run<false>(int cycles, Debugger* debugger);
+template int Chip8::Run<true>(int cycles, Debugger* debugger);
+template int Chip8::RunTimed<false>(uint64_t targetCycle, Debugger* debugger);
+template int Chip8::RunTimed<true>(uint64_t targetCycle, Debugger* debugger);
 
-std::string Chip8::DecodeAndExecute(uint16_t opcode)
+template <typename Quirks>
+void Chip8::Execute(uint16_t opcode)
 {
-	uint8_t  op  = (opcode & 0xF000) >> 12; // 1st nibble - Tells you what kind of instruction it is
 	uint8_t  x   = (opcode & 0x0F00) >> 8;  // 2nd nibble - Used to look up one of the 16 registers (VX) from V0 through VF
 	uint8_t  y   = (opcode & 0x00F0) >> 4;  // 3rd nibble - Used to look up one of the 16 registers (VY) from V0 through VF
 
@@ -72,45 +467,196 @@ std::string Chip8::DecodeAndExecute(uint16_t opcode)
 	uint8_t  nn  = opcode & 0x00FF;   // lowest 8 bits  - Used as an 8-bit immediate value for some instructions
 	uint16_t nnn = opcode & 0x0FFF;   // lowest 12 bits - Used as a 12-bit address for some instructions
 
+	// 1st nibble - Tells you what kind of instruction it is
+	switch (opcode >> 12)
+	{
+		case 0x0:
+			if (opcode == 0x00E0) OP_00E0();
+			else if (opcode == 0x00EE) OP_00EE();
+			else if constexpr (Quirks::superChipOps)
+			{
+				if ((opcode & 0xFFF0) == 0x00C0) OP_00CN(n);
+				else if (opcode == 0x00FB) OP_00FB();
+				else if (opcode == 0x00FC) OP_00FC();
+				else if (opcode == 0x00FD) OP_00FD();
+				else if (opcode == 0x00FE) OP_00FE();
+				else if (opcode == 0x00FF) OP_00FF();
+				else if constexpr (Quirks::xoChipOps)
+				{
+					if ((opcode & 0xFFF0) == 0x00D0) OP_00DN(n);
+				}
+			}
+			break; // 0NNN (machine code routine) is ignored
+
+		case 0x1: OP_1NNN(nnn); break;
+		case 0x2: OP_2NNN(nnn); break;
+		case 0x3: OP_3XNN<Quirks>(x, nn); break;
+		case 0x4: OP_4XNN<Quirks>(x, nn); break;
+
+		case 0x5:
+			if (n == 0x0) OP_5XY0<Quirks>(x, y);
+			else if constexpr (Quirks::xoChipOps)
+			{
+				if (n == 0x2) OP_5XY2(x, y);
+				else if (n == 0x3) OP_5XY3(x, y);
+			}
+			break;
+
+		case 0x6: OP_6XNN(x, nn); break;
+		case 0x7: OP_7XNN(x, nn); break;
+
+		case 0x8:
+			switch (n)
+			{
+				case 0x0: OP_8XY0(x, y); break;
+				case 0x1: OP_8XY1<Quirks>(x, y); break;
+				case 0x2: OP_8XY2<Quirks>(x, y); break;
+				case 0x3: OP_8XY3<Quirks>(x, y); break;
+				case 0x4: OP_8XY4(x, y); break;
+				case 0x5: OP_8XY5(x, y); break;
+				case 0x6: OP_8XY6<Quirks>(x, y); break;
+				case 0x7: OP_8XY7(x, y); break;
+				case 0xE: OP_8XYE<Quirks>(x, y); break;
+			}
+			break;
+
+		case 0x9: if (n == 0x0) OP_9XY0<Quirks>(x, y); break;
+		case 0xA: OP_ANNN(nnn); break;
+		case 0xB: OP_BNNN<Quirks>(nnn); break;
+		case 0xC: OP_CXNN(x, nn); break;
+		case 0xD: OP_DXYN<Quirks>(x, y, n); break;
+
+		case 0xE:
+			if (nn == 0x9E) OP_EX9E<Quirks>(x);
+			else if (nn == 0xA1) OP_EXA1<Quirks>(x);
+			break;
+
+		case 0xF:
+			switch (nn)
+			{
+				case 0x00: if constexpr (Quirks::xoChipOps) { if (x == 0) OP_F000(); } break;
+				case 0x01: if constexpr (Quirks::xoChipOps) { OP_FN01(x); } break;
+				case 0x02: if constexpr (Quirks::xoChipOps) { if (x == 0) OP_F002(); } break;
+				case 0x3A: if constexpr (Quirks::xoChipOps) { OP_FX3A(x); } break;
+				case 0x07: OP_FX07(x); break;
+				case 0x0A: OP_FX0A(x); break;
+				case 0x15: OP_FX15(x); break;
+				case 0x18: OP_FX18(x); break;
+				case 0x1E: OP_FX1E(x); break;
+				case 0x29: OP_FX29(x); break;
+				case 0x33: OP_FX33(x); break;
+				case 0x55: OP_FX55<Quirks>(x); break;
+				case 0x65: OP_FX65<Quirks>(x); break;
+				case 0x30: if constexpr (Quirks::superChipOps) { OP_FX30(x); } break;
+				case 0x75: if constexpr (Quirks::superChipOps) { OP_FX75(x); } break;
+				case 0x85: if constexpr (Quirks::superChipOps) { OP_FX85(x); } break;
+			}
+			break;
+	}
+}
+
+std::string Chip8::Disassemble(uint16_t opcode)
+{
+	uint8_t  x   = (opcode & 0x0F00) >> 8;
+	uint8_t  y   = (opcode & 0x00F0) >> 4;
+	uint8_t  n   = opcode & 0x000F;
+	uint8_t  nn  = opcode & 0x00FF;
+	uint16_t nnn = opcode & 0x0FFF;
+
 	std::stringstream ss;
+	ss << std::hex << std::uppercase;
 
-	switch (op)
+	// Shared operand formats
+	auto vxByte = [&](const char* name) { ss << name << " V" << (int)x << ", 0x" << (int)nn << " (" << std::dec << (int)nn << ")"; };
+	auto vxVy   = [&](const char* name) { ss << name << " V" << (int)x << ", V" << (int)y; };
+	auto vx     = [&](const char* name) { ss << name << " V" << (int)x; };
+	auto unknown = [&]() { ss << "UNK 0x" << std::setfill('0') << std::setw(4) << opcode; };
+
+	switch (opcode >> 12)
 	{
 		case 0x0:
-			OP_00E0();
 			if (opcode == 0x00E0) return "CLS";
-			ss << "SYS 0x" << std::hex << std::uppercase << nnn;
+			if (opcode == 0x00EE) return "RET";
+			if (opcode == 0x00FB) return "SCR";
+			if (opcode == 0x00FC) return "SCL";
+			if (opcode == 0x00FD) return "EXIT";
+			if (opcode == 0x00FE) return "LOW";
+			if (opcode == 0x00FF) return "HIGH";
+			if ((opcode & 0xFFF0) == 0x00C0) { ss << "SCD 0x" << (int)n; break; }
+			if ((opcode & 0xFFF0) == 0x00D0) { ss << "SCU 0x" << (int)n; break; }
+			ss << "SYS 0x" << nnn;
 			break;
 
-		case 0x1: 
-			OP_1NNN(nnn); 
-			ss << "JP 0x" << std::hex << std::uppercase << nnn;
+		case 0x1: ss << "JP 0x" << nnn; break;
+		case 0x2: ss << "CALL 0x" << nnn; break;
+		case 0x3: vxByte("SE"); break;
+		case 0x4: vxByte("SNE"); break;
+		case 0x5:
+			if (n == 0x0) vxVy("SE");
+			else if (n == 0x2) vxVy("SAVE");
+			else if (n == 0x3) vxVy("LOAD");
+			else unknown();
 			break;
 
-		case 0x6:
-			OP_6XNN(x, nn);
-			ss << "LD V" << std::hex << std::uppercase << (int)x << ", 0x" << std::hex << std::uppercase << (int)nn << " (" << std::dec << (int)nn << ")";
-			break;
+		case 0x6: vxByte("LD"); break;
+		case 0x7: vxByte("ADD"); break;
 
-		case 0x7: 
-			OP_7XNN(x, nn); 
-			ss << "ADD V" << std::hex << std::uppercase << (int)x << ", 0x" << std::hex << std::uppercase << (int)nn << " (" << std::dec << (int)nn << ")";
+		case 0x8:
+			switch (n)
+			{
+				case 0x0: vxVy("LD"); break;
+				case 0x1: vxVy("OR"); break;
+				case 0x2: vxVy("AND"); break;
+				case 0x3: vxVy("XOR"); break;
+				case 0x4: vxVy("ADD"); break;
+				case 0x5: vxVy("SUB"); break;
+				case 0x6: vxVy("SHR"); break;
+				case 0x7: vxVy("SUBN"); break;
+				case 0xE: vxVy("SHL"); break;
+				default:  unknown(); break;
+			}
 			break;
 
-		case 0xA:
-			OP_ANNN(nnn); 
-			ss << "LD I, 0x" << std::hex << std::uppercase << nnn;
+		case 0x9: if (n == 0x0) vxVy("SNE"); else unknown(); break;
+		case 0xA: ss << "LD I, 0x" << nnn; break;
+		case 0xB: ss << "JP V0, 0x" << nnn; break;
+		case 0xC: vxByte("RND"); break;
+		case 0xD: ss << "DRW V" << (int)x << ", V" << (int)y << ", 0x" << (int)n << " (" << std::dec << (int)n << ")"; break;
+
+		case 0xE:
+			if (nn == 0x9E) vx("SKP");
+			else if (nn == 0xA1) vx("SKNP");
+			else unknown();
 			break;
-		
-		case 0xD: 
-			OP_DXYN(x, y, n);
-			ss << "DRW V" << std::hex << std::uppercase << (int)x << ", V" << std::hex << std::uppercase << (int)y << ", 0x" << std::hex << std::uppercase << (int)n << " (" << std::dec << (int)n << ")";
+
+		case 0xF:
+			if (opcode == 0xF000) return "LD I, LONG";
+			switch (nn)
+			{
+				case 0x01: ss << "PLANE 0x" << (int)x; break;
+				case 0x02: if (x == 0) ss << "AUDIO"; else unknown(); break;
+				case 0x3A: ss << "PITCH V" << (int)x; break;
+				case 0x07: vx("LD"); ss << ", DT"; break;
+				case 0x0A: vx("LD"); ss << ", K"; break;
+				case 0x15: ss << "LD DT, V" << (int)x; break;
+				case 0x18: ss << "LD ST, V" << (int)x; break;
+				case 0x1E: ss << "ADD I, V" << (int)x; break;
+				case 0x29: ss << "LD F, V" << (int)x; break;
+				case 0x33: ss << "LD B, V" << (int)x; break;
+				case 0x55: ss << "LD [I], V" << (int)x; break;
+				case 0x65: vx("LD"); ss << ", [I]"; break;
+				case 0x30: ss << "LD HF, V" << (int)x; break;
+				case 0x75: ss << "LD R, V" << (int)x; break;
+				case 0x85: vx("LD"); ss << ", R"; break;
+				default:   unknown(); break;
+			}
 			break;
-			
+
 		default:
-			ss << "UNK 0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << opcode;
+			unknown();
 			break;
 	}
-	
+
 	return ss.str();
-}
\ No newline at end of file
+}
+
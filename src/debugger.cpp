@@ -0,0 +1,156 @@
+#include "debugger.h"
+#include "chip8.h"
+
+void Debugger::ToggleBreakpoint(uint16_t address)
+{
+	breakpoints.flip(address % MEMORY_SIZE);
+}
+
+void Debugger::AddCondition(uint8_t reg, Compare cmp, uint8_t value)
+{
+	conditions.push_back({ static_cast<uint8_t>(reg & 0xF), cmp, value, true, false });
+}
+
+void Debugger::SetWatch(uint16_t start, uint16_t end, bool onRead, bool onWrite)
+{
+	for (unsigned int addr = start; addr <= end && addr < MEMORY_SIZE; ++addr)
+	{
+		if (onRead)  readWatch.set(addr);
+		if (onWrite) writeWatch.set(addr);
+	}
+}
+
+void Debugger::ClearWatch(uint16_t start, uint16_t end)
+{
+	for (unsigned int addr = start; addr <= end && addr < MEMORY_SIZE; ++addr)
+	{
+		readWatch.reset(addr);
+		writeWatch.reset(addr);
+	}
+}
+
+bool Debugger::ConsumeHit()
+{
+	bool hit = hitPending;
+	hitPending = false;
+	return hit;
+}
+
+void Debugger::ClearAll()
+{
+	breakpoints.reset();
+	readWatch.reset();
+	writeWatch.reset();
+	conditions.clear();
+	ClearHit();
+}
+
+bool Debugger::IsActive() const
+{
+	return breakpoints.any() || readWatch.any() || writeWatch.any() || !conditions.empty();
+}
+
+bool Debugger::Check(const Chip8& chip8)
+{
+	// Evaluate the conditions even when skipping so their edge state stays current
+	bool conditionHit = false;
+	for (Condition& c : conditions)
+	{
+		uint8_t v = chip8.registers[c.reg];
+		bool isTrue = false;
+		switch (c.cmp)
+		{
+			case Compare::Equal:    isTrue = v == c.value; break;
+			case Compare::NotEqual: isTrue = v != c.value; break;
+			case Compare::Less:     isTrue = v <  c.value; break;
+			case Compare::Greater:  isTrue = v >  c.value; break;
+		}
+		if (c.enabled && isTrue && !c.wasTrue) conditionHit = true;
+		c.wasTrue = isTrue;
+	}
+
+	if (skipNext)
+	{
+		skipNext = false;
+		return false;
+	}
+
+	if (breakpoints.test(chip8.pc % MEMORY_SIZE))
+	{
+		return Record(HitType::Breakpoint, chip8.pc, chip8.pc);
+	}
+
+	if (conditionHit)
+	{
+		return Record(HitType::Condition, chip8.pc, chip8.pc);
+	}
+
+	uint16_t opcode = chip8.Read(chip8.pc) << 8 | chip8.Read(chip8.pc + 1);
+	return CheckAccess(chip8, opcode);
+}
+
+// Work out which memory the instruction is about to touch, without executing it
+bool Debugger::CheckAccess(const Chip8& chip8, uint16_t opcode)
+{
+	uint16_t start = chip8.index;
+	unsigned int length = 0;
+	bool isWrite = false;
+
+	switch (opcode & 0xF000)
+	{
+		case 0xD000: // DRW reads N sprite bytes (32 for a 16x16 sprite) from I for each selected plane
+		{
+			unsigned int n = opcode & 0x000F;
+			if (n == 0) n = (chip8.variant == Variant::Chip8) ? 0 : 32;
+			unsigned int planes = 0;
+			for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane) planes += (chip8.planeMask >> plane) & 1;
+			length = n * planes;
+			break;
+		}
+
+		case 0x5000: // XO-CHIP save/load VX..VY at I
+		{
+			unsigned int x = (opcode & 0x0F00) >> 8;
+			unsigned int y = (opcode & 0x00F0) >> 4;
+			if ((opcode & 0xF) != 0x2 && (opcode & 0xF) != 0x3) return false;
+			length = (x > y ? x - y : y - x) + 1;
+			isWrite = (opcode & 0xF) == 0x2;
+			break;
+		}
+
+		case 0xF000:
+			switch (opcode & 0x00FF)
+			{
+				case 0x02: length = AUDIO_PATTERN_SIZE; break;                      // audio pattern from I
+				case 0x33: length = 3; isWrite = true; break;                       // BCD writes I..I+2
+				case 0x55: length = ((opcode & 0x0F00) >> 8) + 1; isWrite = true; break; // store V0..VX
+				case 0x65: length = ((opcode & 0x0F00) >> 8) + 1; break;             // load V0..VX
+				default: return false;
+			}
+			break;
+
+		default:
+			return false;
+	}
+
+	const std::bitset<MEMORY_SIZE>& watch = isWrite ? writeWatch : readWatch;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		uint16_t addr = (start + i) % MEMORY_SIZE;
+		if (watch.test(addr))
+		{
+			return Record(isWrite ? HitType::WriteWatch : HitType::ReadWatch, chip8.pc, addr);
+		}
+	}
+
+	return false;
+}
+
+bool Debugger::Record(HitType type, uint16_t pc, uint16_t address)
+{
+	lastHit.type = type;
+	lastHit.pc = pc;
+	lastHit.address = address;
+	hitPending = true;
+	return true;
+}
@@ -0,0 +1,324 @@
+#include "explorer.h"
+#include "chip8.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+StateSet::StateSet(size_t capacity)
+{
+	size_t slotCount = 1024;
+	while (slotCount < capacity) slotCount <<= 1;
+	slots.reset(new Slot[slotCount]);
+	mask = slotCount - 1;
+	limit = slotCount / 4 * 3;
+}
+
+// 0 marks an empty slot, so the one hash that collides with it moves over
+static uint64_t SlotHash(uint64_t hash)
+{
+	return hash ? hash : 1;
+}
+
+bool StateSet::Insert(uint64_t hash, uint64_t owner)
+{
+	hash = SlotHash(hash);
+	for (size_t i = (hash ^ (hash >> 32)) & mask; ; i = (i + 1) & mask)
+	{
+		Slot& slot = slots[i];
+		uint64_t current = slot.hash.load(std::memory_order_acquire);
+		if (current == 0)
+		{
+			if (size.load(std::memory_order_relaxed) >= limit) return false;
+			if (slot.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel))
+			{
+				size.fetch_add(1, std::memory_order_relaxed);
+				current = hash;
+			}
+			// Otherwise `current` is whatever another thread put there
+		}
+		if (current != hash) continue;
+
+		uint64_t previous = slot.owner.load(std::memory_order_relaxed);
+		while (owner < previous && !slot.owner.compare_exchange_weak(previous, owner, std::memory_order_relaxed)) {}
+		return true;
+	}
+}
+
+uint64_t StateSet::Owner(uint64_t hash) const
+{
+	hash = SlotHash(hash);
+	for (size_t i = (hash ^ (hash >> 32)) & mask; ; i = (i + 1) & mask)
+	{
+		uint64_t current = slots[i].hash.load(std::memory_order_acquire);
+		if (current == 0) return UINT64_MAX;
+		if (current == hash) return slots[i].owner.load(std::memory_order_relaxed);
+	}
+}
+
+// Threads started once for the whole search. ForEach hands out items in small
+// chunks from an atomic counter; the calling thread works too, as worker 0.
+class WorkerPool
+{
+public:
+	explicit WorkerPool(unsigned int count)
+	{
+		for (unsigned int id = 1; id < count; ++id) threads.emplace_back(&WorkerPool::Worker, this, id);
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& thread : threads) thread.join();
+	}
+
+	unsigned int Size() const { return static_cast<unsigned int>(threads.size()) + 1; }
+
+	// job(item, worker) for every item in [0, count); returns when all are done
+	void ForEach(size_t count, const std::function<void(size_t, unsigned int)>& job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			current = &job;
+			items = count;
+			next = 0;
+			busy = static_cast<unsigned int>(threads.size());
+			++generation;
+		}
+		wake.notify_all();
+		Drain(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return busy == 0; });
+		current = nullptr;
+	}
+
+private:
+	static const size_t CHUNK = 8;
+
+	void Drain(unsigned int id)
+	{
+		for (size_t first = next.fetch_add(CHUNK); first < items; first = next.fetch_add(CHUNK))
+		{
+			size_t last = std::min(first + CHUNK, items);
+			for (size_t item = first; item < last; ++item) (*current)(item, id);
+		}
+	}
+
+	void Worker(unsigned int id)
+	{
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			wake.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+
+			lock.unlock();
+			Drain(id);
+			lock.lock();
+			if (--busy == 0) done.notify_one();
+		}
+	}
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(size_t, unsigned int)>* current = nullptr;
+	size_t items = 0;
+	std::atomic<size_t> next{0};
+	uint64_t generation = 0;
+	unsigned int busy = 0;
+	bool stopping = false;
+};
+
+// Hold `keys` for one step, calling visit(address) for every instruction executed.
+// Same pacing as the headless runner and golden runs.
+template <typename Visit>
+static void Step(Chip8& chip8, uint16_t keys, const ExploreOptions& options, Visit visit)
+{
+	for (uint8_t key = 0; key < 16; ++key)
+	{
+		bool down = (keys >> key) & 1;
+		if (chip8.IsKeyDown(key) != down) chip8.SetKey(key, down);
+	}
+
+	for (unsigned int frame = 0; frame < options.stepFrames; ++frame)
+	{
+		unsigned int budget = chip8.hires ? options.cyclesPerFrame * 4 : options.cyclesPerFrame;
+		for (unsigned int i = 0; i < budget; ++i)
+		{
+			// A polling loop has nothing new to visit: let Run skip to the end of the frame
+			if (chip8.idle)
+			{
+				chip8.Run<false>(budget - i);
+				break;
+			}
+			uint16_t address = chip8.pc;
+			if (chip8.Run<false>(1) == 0) break; // waiting for the display or halted
+			visit(address);
+		}
+		chip8.TickTimers();
+	}
+}
+
+ExploreResult Explore(const Chip8& start, const ExploreOptions& options)
+{
+	auto begin = std::chrono::high_resolution_clock::now();
+	ExploreResult result;
+
+	std::vector<uint16_t> inputs = options.inputs;
+	if (inputs.empty())
+	{
+		inputs.push_back(0);
+		for (unsigned int key = 0; key < 16; ++key) inputs.push_back(static_cast<uint16_t>(1 << key));
+	}
+
+	WorkerPool pool(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()));
+	StateSet visited(options.maxStates);
+
+	// Every kept state, as a tree of the input that led to it from its parent
+	struct Node
+	{
+		uint32_t parent;
+		uint16_t keys;
+	};
+	std::vector<Node> nodes = { { UINT32_MAX, 0 } };
+	auto path = [&](uint32_t node, uint16_t last)
+	{
+		std::vector<uint16_t> keys = { last };
+		for (; nodes[node].parent != UINT32_MAX; node = nodes[node].parent) keys.push_back(nodes[node].keys);
+		std::reverse(keys.begin(), keys.end());
+		return keys;
+	};
+
+	std::vector<Chip8> frontier(1, start);
+	std::vector<uint32_t> frontierNodes = { 0 };
+	visited.Insert(start.StateHash(), 0);
+	result.unique = 1;
+
+	// Instruction addresses executed so far. Read-only while a step runs, so
+	// every state is scored against the same coverage whatever order they run in.
+	std::vector<uint8_t> covered(MEMORY_SIZE);
+
+	struct Candidate
+	{
+		uint64_t hash;
+		std::vector<uint16_t> fresh; // addresses not in `covered`
+	};
+
+	// Per worker: a machine to run children on, and the addresses it has marked for the current child
+	std::vector<Chip8> scratch(pool.Size());
+	std::vector<std::vector<uint64_t>> marked(pool.Size(), std::vector<uint64_t>(MEMORY_SIZE / 64));
+
+	uint64_t firstId = 1; // candidate ids grow with depth, so an earlier path to a state always owns it
+	for (; result.depth < options.depth && !frontier.empty() && !result.tableFull; ++result.depth)
+	{
+		size_t count = frontier.size() * inputs.size();
+		std::vector<Candidate> candidates(count);
+		std::atomic<bool> full{false};
+
+		// Run every (state, input) pair
+		pool.ForEach(count, [&](size_t item, unsigned int worker)
+		{
+			size_t parent = item / inputs.size();
+			Chip8& chip8 = scratch[worker];
+			std::vector<uint64_t>& seen = marked[worker];
+			Candidate& candidate = candidates[item];
+
+			chip8 = frontier[parent];
+			Step(chip8, inputs[item % inputs.size()], options, [&](uint16_t address)
+			{
+				if (covered[address]) return;
+				uint64_t bit = uint64_t(1) << (address & 63);
+				if (seen[address >> 6] & bit) return;
+				seen[address >> 6] |= bit;
+				candidate.fresh.push_back(address);
+			});
+			for (uint16_t address : candidate.fresh) seen[address >> 6] = 0;
+			std::sort(candidate.fresh.begin(), candidate.fresh.end());
+
+			candidate.hash = chip8.StateHash();
+			if (!visited.Insert(candidate.hash, firstId + item)) full = true;
+		});
+		result.expanded += count;
+		result.tableFull = full;
+
+		// Keep the states this step reached first, report new coverage in order
+		std::vector<size_t> kept;
+		for (size_t item = 0; item < count; ++item)
+		{
+			Candidate& candidate = candidates[item];
+			if (visited.Owner(candidate.hash) != firstId + item) continue;
+			kept.push_back(item);
+
+			ExploreDiscovery discovery;
+			for (uint16_t address : candidate.fresh)
+			{
+				if (!covered[address]) discovery.addresses.push_back(address);
+			}
+			if (discovery.addresses.empty()) continue;
+			for (uint16_t address : discovery.addresses) covered[address] = 1;
+			result.covered += discovery.addresses.size();
+			discovery.inputs = path(frontierNodes[item / inputs.size()], inputs[item % inputs.size()]);
+			result.discoveries.push_back(std::move(discovery));
+		}
+		result.unique += kept.size();
+		firstId += count;
+
+		// Beam: the states that found the most new code, ties broken by hash (an arbitrary but repeatable spread)
+		if (options.beam && kept.size() > options.beam)
+		{
+			std::partial_sort(kept.begin(), kept.begin() + options.beam, kept.end(), [&](size_t a, size_t b)
+			{
+				if (candidates[a].fresh.size() != candidates[b].fresh.size()) return candidates[a].fresh.size() > candidates[b].fresh.size();
+				return candidates[a].hash < candidates[b].hash;
+			});
+			kept.resize(options.beam);
+		}
+
+		// Only the kept states are stored: run them again from their parents, which is
+		// cheaper than holding a full machine for every candidate
+		std::vector<Chip8> next(kept.size());
+		std::vector<uint32_t> nextNodes(kept.size());
+		for (size_t i = 0; i < kept.size(); ++i)
+		{
+			nextNodes[i] = static_cast<uint32_t>(nodes.size());
+			nodes.push_back({ frontierNodes[kept[i] / inputs.size()], inputs[kept[i] % inputs.size()] });
+		}
+		pool.ForEach(kept.size(), [&](size_t i, unsigned int)
+		{
+			next[i] = frontier[kept[i] / inputs.size()];
+			Step(next[i], inputs[kept[i] % inputs.size()], options, [](uint16_t) {});
+		});
+		frontier.swap(next);
+		frontierNodes.swap(nextNodes);
+	}
+
+	result.elapsedMs = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - begin).count();
+	return result;
+}
+
+std::string FormatInputs(const std::vector<uint16_t>& inputs)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	std::string text;
+	for (uint16_t keys : inputs)
+	{
+		if (!text.empty()) text += ' ';
+		if (keys == 0) text += '-';
+		for (unsigned int key = 0; key < 16; ++key)
+		{
+			if ((keys >> key) & 1) text += digits[key];
+		}
+	}
+	return text;
+}
@@ -0,0 +1,117 @@
+#include "file_watcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Wait this long after the last change before reporting it, so a build that
+// writes the ROM in several steps triggers one reload of the finished file
+static const int SETTLE_MS = 50;
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+#ifdef __linux__
+
+bool FileWatcher::Watch(const std::string& path)
+{
+	Stop();
+
+	size_t slash = path.find_last_of('/');
+	std::string directory = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+	std::string fileName = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+	int inotifyFd = inotify_init1(IN_CLOEXEC);
+	if (inotifyFd < 0)
+	{
+		std::cout << "Failed to start file watcher: " << std::strerror(errno) << std::endl;
+		return false;
+	}
+
+	if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+	{
+		std::cout << "Failed to watch " << directory << ": " << std::strerror(errno) << std::endl;
+		close(inotifyFd);
+		return false;
+	}
+
+	stopFd = eventfd(0, EFD_CLOEXEC);
+	if (stopFd < 0)
+	{
+		close(inotifyFd);
+		return false;
+	}
+
+	changed.store(false, std::memory_order_relaxed);
+	thread = std::thread(&FileWatcher::Worker, this, inotifyFd, stopFd, fileName);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (!thread.joinable()) return;
+
+	eventfd_write(stopFd, 1);
+	thread.join();
+	close(stopFd);
+	stopFd = -1;
+}
+
+void FileWatcher::Worker(int inotifyFd, int wakeFd, std::string fileName)
+{
+	alignas(inotify_event) char buffer[4096];
+	bool pending = false;
+
+	for (;;)
+	{
+		// Block until something happens; once a change is pending, only until it settles
+		pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+		int ready = poll(fds, 2, pending ? SETTLE_MS : -1);
+		if (ready < 0 && errno != EINTR) break;
+		if (fds[1].revents & POLLIN) break;
+
+		if (ready == 0)
+		{
+			// Quiet for SETTLE_MS: report the change
+			changed.store(true, std::memory_order_release);
+			pending = false;
+			continue;
+		}
+
+		if (!(fds[0].revents & POLLIN)) continue;
+
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			if (event->len > 0 && fileName == event->name) pending = true;
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	close(inotifyFd);
+}
+
+#else
+
+bool FileWatcher::Watch(const std::string& path)
+{
+	return false;
+}
+
+void FileWatcher::Stop()
+{
+}
+
+void FileWatcher::Worker(int inotifyFd, int wakeFd, std::string fileName)
+{
+}
+
+#endif
@@ -0,0 +1,576 @@
+#include "gdb_stub.h"
+#include "chip8.h"
+#include "debugger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Register layout for 'g'/'G'/'p'/'P': 16 x V (1 byte), I and PC (2 bytes,
+// little-endian), SP, DT and ST (1 byte). Matches target.xml below.
+static const unsigned int REG_I = 16, REG_PC = 17, REG_SP = 18, REG_DT = 19, REG_ST = 20, REG_COUNT = 21;
+
+static const char* targetXml =
+	"<?xml version=\"1.0\"?>"
+	"<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+	"<target version=\"1.0\">"
+	"<feature name=\"org.chip8.core\">"
+	"<reg name=\"v0\" bitsize=\"8\" regnum=\"0\"/><reg name=\"v1\" bitsize=\"8\"/><reg name=\"v2\" bitsize=\"8\"/><reg name=\"v3\" bitsize=\"8\"/>"
+	"<reg name=\"v4\" bitsize=\"8\"/><reg name=\"v5\" bitsize=\"8\"/><reg name=\"v6\" bitsize=\"8\"/><reg name=\"v7\" bitsize=\"8\"/>"
+	"<reg name=\"v8\" bitsize=\"8\"/><reg name=\"v9\" bitsize=\"8\"/><reg name=\"va\" bitsize=\"8\"/><reg name=\"vb\" bitsize=\"8\"/>"
+	"<reg name=\"vc\" bitsize=\"8\"/><reg name=\"vd\" bitsize=\"8\"/><reg name=\"ve\" bitsize=\"8\"/><reg name=\"vf\" bitsize=\"8\"/>"
+	"<reg name=\"i\" bitsize=\"16\" type=\"data_ptr\"/>"
+	"<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+	"<reg name=\"sp\" bitsize=\"8\"/>"
+	"<reg name=\"dt\" bitsize=\"8\"/>"
+	"<reg name=\"st\" bitsize=\"8\"/>"
+	"</feature>"
+	"</target>";
+
+static std::string ToHex(const uint8_t* data, size_t size)
+{
+	static const char digits[] = "0123456789abcdef";
+	std::string out;
+	for (size_t i = 0; i < size; ++i)
+	{
+		out += digits[data[i] >> 4];
+		out += digits[data[i] & 0xF];
+	}
+	return out;
+}
+
+static bool FromHex(const std::string& text, std::vector<uint8_t>& out)
+{
+	if (text.size() % 2) return false;
+	out.clear();
+	for (size_t i = 0; i < text.size(); i += 2)
+	{
+		char pair[3] = { text[i], text[i + 1], 0 };
+		char* end = nullptr;
+		out.push_back(static_cast<uint8_t>(std::strtoul(pair, &end, 16)));
+		if (*end) return false;
+	}
+	return true;
+}
+
+// Register number -> bytes in the order GDB sends them
+static size_t RegisterSize(unsigned int reg)
+{
+	return (reg == REG_I || reg == REG_PC) ? 2 : 1;
+}
+
+static void ReadRegister(const Chip8& chip8, unsigned int reg, uint8_t* out)
+{
+	if (reg < REGISTER_COUNT) out[0] = chip8.registers[reg];
+	else if (reg == REG_I)  { out[0] = chip8.index & 0xFF; out[1] = chip8.index >> 8; }
+	else if (reg == REG_PC) { out[0] = chip8.pc & 0xFF; out[1] = chip8.pc >> 8; }
+	else if (reg == REG_SP) out[0] = chip8.sp;
+	else if (reg == REG_DT) out[0] = chip8.delayTimer;
+	else if (reg == REG_ST) out[0] = chip8.soundTimer;
+}
+
+static void WriteRegister(Chip8& chip8, unsigned int reg, const uint8_t* in)
+{
+	if (reg < REGISTER_COUNT) chip8.registers[reg] = in[0];
+	else if (reg == REG_I)  chip8.index = in[0] | in[1] << 8;
+	else if (reg == REG_PC) chip8.pc = in[0] | in[1] << 8;
+	else if (reg == REG_SP) chip8.sp = in[0] % (STACK_SIZE + 1);
+	else if (reg == REG_DT) chip8.delayTimer = in[0];
+	else if (reg == REG_ST) chip8.soundTimer = in[0];
+}
+
+GdbStub::~GdbStub()
+{
+	Stop();
+}
+
+bool GdbStub::IsStopped() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return holdUntilAttached || state != RunState::Running;
+}
+
+void GdbStub::Wake()
+{
+#ifndef _WIN32
+	char byte = 1;
+	if (write(wakePipe[1], &byte, 1) < 0) return;
+#endif
+}
+
+void GdbStub::QueueStopReply(const std::string& stopReply)
+{
+	// Called with the mutex held
+	stopReplies.push_back(stopReply);
+	Wake();
+}
+
+void GdbStub::ReportBreak()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!attached || state != RunState::Running) return;
+	state = RunState::Stopped;
+	QueueStopReply("S05");
+}
+
+void GdbStub::Service(Chip8& chip8, Debugger& debugger, bool vipTiming)
+{
+	if (!attached.load(std::memory_order_acquire)) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Ctrl-C from the debugger
+	if (interruptRequested.exchange(false) && state == RunState::Running)
+	{
+		state = RunState::Stopped;
+		QueueStopReply("S02");
+	}
+
+	if (requestPending)
+	{
+		requestPending = false;
+		bool sendReply = true;
+		reply = HandleMachine(request, chip8, debugger, sendReply);
+		replyWanted = sendReply;
+		replyReady = true;
+		replied.notify_all();
+	}
+
+	// One instruction, ignoring breakpoints, then stop again. Same path as a normal run, so the timing matches.
+	if (state == RunState::Stepping)
+	{
+		// Out of an idle loop or display wait first, or the step would run nothing
+		chip8.idle = false;
+		chip8.waitingForVBlank = false;
+		if (vipTiming) chip8.RunTimed<false>(chip8.machineCycles + 1);
+		else chip8.Run<false>(1);
+		state = RunState::Stopped;
+		QueueStopReply("S05");
+	}
+}
+
+// Requests that read or change the machine; runs on the emulation loop with the mutex held
+std::string GdbStub::HandleMachine(const std::string& packet, Chip8& chip8, Debugger& debugger, bool& sendReply)
+{
+	char command = packet[0];
+	std::string args = packet.substr(1);
+
+	switch (command)
+	{
+		case '?':
+			return "S05";
+
+		case 'g':
+		{
+			std::string out;
+			for (unsigned int reg = 0; reg < REG_COUNT; ++reg)
+			{
+				uint8_t bytes[2];
+				ReadRegister(chip8, reg, bytes);
+				out += ToHex(bytes, RegisterSize(reg));
+			}
+			return out;
+		}
+
+		case 'G':
+		{
+			std::vector<uint8_t> bytes;
+			if (!FromHex(args, bytes)) return "E01";
+			size_t offset = 0;
+			for (unsigned int reg = 0; reg < REG_COUNT && offset + RegisterSize(reg) <= bytes.size(); ++reg)
+			{
+				WriteRegister(chip8, reg, &bytes[offset]);
+				offset += RegisterSize(reg);
+			}
+			return "OK";
+		}
+
+		case 'p':
+		{
+			unsigned int reg = std::strtoul(args.c_str(), nullptr, 16);
+			if (reg >= REG_COUNT) return "E01";
+			uint8_t bytes[2];
+			ReadRegister(chip8, reg, bytes);
+			return ToHex(bytes, RegisterSize(reg));
+		}
+
+		case 'P':
+		{
+			size_t equals = args.find('=');
+			if (equals == std::string::npos) return "E01";
+			unsigned int reg = std::strtoul(args.substr(0, equals).c_str(), nullptr, 16);
+			std::vector<uint8_t> bytes;
+			if (reg >= REG_COUNT || !FromHex(args.substr(equals + 1), bytes) || bytes.size() < RegisterSize(reg)) return "E01";
+			WriteRegister(chip8, reg, bytes.data());
+			return "OK";
+		}
+
+		case 'm':
+		case 'M':
+		{
+			unsigned long address = 0, length = 0;
+			if (std::sscanf(args.c_str(), "%lx,%lx", &address, &length) != 2 || length > 0x1000) return "E01";
+			if (command == 'm')
+			{
+				std::vector<uint8_t> bytes(length);
+				for (unsigned long i = 0; i < length; ++i) bytes[i] = chip8.Read(static_cast<uint16_t>(address + i));
+				return ToHex(bytes.data(), bytes.size());
+			}
+
+			size_t colon = args.find(':');
+			std::vector<uint8_t> bytes;
+			if (colon == std::string::npos || !FromHex(args.substr(colon + 1), bytes) || bytes.size() != length) return "E01";
+			for (unsigned long i = 0; i < length; ++i) chip8.Write(static_cast<uint16_t>(address + i), bytes[i]);
+			return "OK";
+		}
+
+		case 'c':
+		case 's':
+			if (!args.empty()) chip8.pc = static_cast<uint16_t>(std::strtoul(args.c_str(), nullptr, 16));
+			holdUntilAttached = false;
+			sendReply = false; // the stop reply comes later
+			if (command == 'c')
+			{
+				// Don't stop straight away on the breakpoint we're sitting on
+				debugger.Resume();
+				state = RunState::Running;
+			}
+			else
+			{
+				state = RunState::Stepping;
+			}
+			return "";
+
+		case 'Z':
+		case 'z':
+		{
+			unsigned int type = 0;
+			unsigned long address = 0, kind = 1;
+			if (std::sscanf(args.c_str(), "%u,%lx,%lx", &type, &address, &kind) < 2 || address >= MEMORY_SIZE) return "E01";
+			bool set = command == 'Z';
+			if (type <= 1)
+			{
+				debugger.breakpoints.set(address, set);
+				return "OK";
+			}
+			if (type > 4) return "";
+
+			// Watchpoints cover `kind` bytes
+			for (unsigned long a = address; a < address + std::max(kind, 1ul) && a < MEMORY_SIZE; ++a)
+			{
+				if (type == 2 || type == 4) debugger.writeWatch.set(a, set);
+				if (type == 3 || type == 4) debugger.readWatch.set(a, set);
+			}
+			return "OK";
+		}
+	}
+
+	return "";
+}
+
+// Requests the socket thread can answer itself, or hand to the emulation loop
+std::string GdbStub::Handle(const std::string& packet, bool& sendReply)
+{
+	sendReply = true;
+	if (packet.empty()) return "";
+
+	if (packet.compare(0, 10, "qSupported") == 0) return "PacketSize=1000;qXfer:features:read+;QStartNoAckMode+";
+	if (packet == "QStartNoAckMode") return "OK";
+	if (packet == "qAttached") return "1";
+	if (packet == "qC") return "QC1";
+	if (packet == "qfThreadInfo") return "m1";
+	if (packet == "qsThreadInfo") return "l";
+	if (packet[0] == 'H') return "OK";
+	if (packet[0] == 'T') return "OK"; // thread alive
+
+	// Target description, in chunks
+	const std::string xfer = "qXfer:features:read:target.xml:";
+	if (packet.compare(0, xfer.size(), xfer) == 0)
+	{
+		unsigned long offset = 0, length = 0;
+		std::sscanf(packet.c_str() + xfer.size(), "%lx,%lx", &offset, &length);
+		std::string xml = targetXml;
+		if (offset >= xml.size()) return "l";
+		std::string chunk = xml.substr(offset, length);
+		return (offset + chunk.size() >= xml.size() ? "l" : "m") + chunk;
+	}
+
+	if (packet[0] == 'D' || packet[0] == 'k')
+	{
+		// Detach / kill: let the emulator run freely again
+		std::lock_guard<std::mutex> lock(mutex);
+		state = RunState::Running;
+		holdUntilAttached = false;
+		sendReply = packet[0] == 'D';
+		return "OK";
+	}
+
+	if (std::strchr("?gGpPmMcsZz", packet[0]) == nullptr) return "";
+
+	// Hand it to the emulation loop and wait for the answer
+	std::unique_lock<std::mutex> lock(mutex);
+	request = packet;
+	requestPending = true;
+	replyReady = false;
+	replied.wait(lock, [this] { return replyReady || stopping.load(); });
+	sendReply = replyReady && replyWanted;
+	return reply;
+}
+
+#ifndef _WIN32
+
+bool GdbStub::Start(const std::string& address, bool waitForClient, std::string& error)
+{
+	Stop();
+
+	int listenFd = -1;
+	if (!address.empty() && address.find_first_not_of("0123456789") == std::string::npos)
+	{
+		listenFd = socket(AF_INET, SOCK_STREAM, 0);
+		int on = 1;
+		setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+		// Localhost only: the protocol has no authentication
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<uint16_t>(std::stoi(address)));
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+		{
+			error = "Failed to listen on port " + address + ": " + std::strerror(errno);
+			close(listenFd);
+			return false;
+		}
+	}
+	else
+	{
+		sockaddr_un addr{};
+		if (address.empty() || address.size() >= sizeof(addr.sun_path))
+		{
+			error = "Bad socket path: " + address;
+			return false;
+		}
+		listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+		addr.sun_family = AF_UNIX;
+		std::strncpy(addr.sun_path, address.c_str(), sizeof(addr.sun_path) - 1);
+		unlink(address.c_str());
+		if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+		{
+			error = "Failed to listen on " + address + ": " + std::strerror(errno);
+			close(listenFd);
+			return false;
+		}
+		unixPath = address;
+	}
+
+	if (listen(listenFd, 1) < 0 || pipe(wakePipe) < 0)
+	{
+		error = std::string("Failed to start GDB stub: ") + std::strerror(errno);
+		close(listenFd);
+		return false;
+	}
+
+	holdUntilAttached = waitForClient;
+	state = RunState::Running;
+	stopping = false;
+	thread = std::thread(&GdbStub::Worker, this, listenFd);
+	return true;
+}
+
+void GdbStub::Stop()
+{
+	if (!thread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		replied.notify_all();
+	}
+	Wake();
+	thread.join();
+
+	close(wakePipe[0]);
+	close(wakePipe[1]);
+	wakePipe[0] = wakePipe[1] = -1;
+	if (!unixPath.empty())
+	{
+		unlink(unixPath.c_str());
+		unixPath.clear();
+	}
+	attached = false;
+	holdUntilAttached = false;
+	state = RunState::Running;
+}
+
+void GdbStub::Worker(int listenFd)
+{
+	while (!stopping)
+	{
+		pollfd fds[2] = { { listenFd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+		if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+		if (fds[1].revents & POLLIN)
+		{
+			char drain[64];
+			if (read(wakePipe[0], drain, sizeof(drain)) < 0) {}
+			continue;
+		}
+		if (!(fds[0].revents & POLLIN)) continue;
+
+		int clientFd = accept(listenFd, nullptr, nullptr);
+		if (clientFd < 0) continue;
+
+		// GDB expects the target to be stopped when it attaches
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			state = RunState::Stopped;
+			stopReplies.clear();
+			noAck = false;
+		}
+		attached = true;
+		std::cout << "GDB attached" << std::endl;
+
+		Serve(clientFd);
+		close(clientFd);
+
+		attached = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			state = RunState::Running;
+			holdUntilAttached = false;
+			requestPending = false;
+		}
+		std::cout << "GDB detached" << std::endl;
+	}
+	close(listenFd);
+}
+
+bool GdbStub::SendPacket(int clientFd, const std::string& payload)
+{
+	uint8_t checksum = 0;
+	for (char c : payload) checksum += static_cast<uint8_t>(c);
+	char trailer[4];
+	std::snprintf(trailer, sizeof(trailer), "#%02x", checksum);
+	std::string packet = "$" + payload + trailer;
+
+	for (size_t sent = 0; sent < packet.size(); )
+	{
+		ssize_t n = send(clientFd, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+		if (n <= 0) return false;
+		sent += n;
+	}
+	return true;
+}
+
+void GdbStub::Serve(int clientFd)
+{
+	std::string buffer;
+	char chunk[4096];
+
+	while (!stopping)
+	{
+		pollfd fds[2] = { { clientFd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+		if (poll(fds, 2, -1) < 0 && errno != EINTR) return;
+
+		// Stop notifications from the emulation loop
+		if (fds[1].revents & POLLIN)
+		{
+			char drain[64];
+			if (read(wakePipe[0], drain, sizeof(drain)) < 0) {}
+
+			std::vector<std::string> pending;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending.swap(stopReplies);
+			}
+			for (const std::string& stopReply : pending)
+			{
+				if (!SendPacket(clientFd, stopReply)) return;
+			}
+		}
+
+		if (!(fds[0].revents & (POLLIN | POLLHUP))) continue;
+		ssize_t received = recv(clientFd, chunk, sizeof(chunk), 0);
+		if (received <= 0) return;
+		buffer.append(chunk, received);
+
+		while (!buffer.empty())
+		{
+			char c = buffer[0];
+			if (c == 0x03)
+			{
+				interruptRequested = true;
+				buffer.erase(0, 1);
+				continue;
+			}
+			if (c != '$')
+			{
+				buffer.erase(0, 1); // acks, and anything unexpected
+				continue;
+			}
+
+			// $payload#xx
+			size_t hash = buffer.find('#');
+			if (hash == std::string::npos || hash + 2 >= buffer.size()) break;
+			std::string payload = buffer.substr(1, hash - 1);
+			unsigned int expected = std::strtoul(buffer.substr(hash + 1, 2).c_str(), nullptr, 16);
+			buffer.erase(0, hash + 3);
+
+			uint8_t checksum = 0;
+			for (char p : payload) checksum += static_cast<uint8_t>(p);
+			if (!noAck)
+			{
+				const char* ack = checksum == expected ? "+" : "-";
+				if (send(clientFd, ack, 1, MSG_NOSIGNAL) <= 0) return;
+			}
+			if (checksum != expected) continue;
+
+			bool sendReply = true;
+			std::string response = Handle(payload, sendReply);
+			if (sendReply && !SendPacket(clientFd, response)) return;
+			if (payload == "QStartNoAckMode") noAck = true;
+			if (payload[0] == 'D' || payload[0] == 'k') return;
+		}
+	}
+}
+
+#else
+
+bool GdbStub::Start(const std::string& address, bool waitForClient, std::string& error)
+{
+	error = "The GDB stub isn't available on this platform";
+	return false;
+}
+
+void GdbStub::Stop()
+{
+}
+
+void GdbStub::Worker(int listenFd)
+{
+}
+
+void GdbStub::Serve(int clientFd)
+{
+}
+
+bool GdbStub::SendPacket(int clientFd, const std::string& payload)
+{
+	return false;
+}
+
+#endif
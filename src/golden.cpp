@@ -0,0 +1,212 @@
+#include "golden.h"
+#include "chip8.h"
+#include "rom.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Same pacing as the headless runner
+static const unsigned int GOLDEN_CYCLES_PER_FRAME = 12;
+
+bool LoadGoldenManifest(const std::string& path, std::vector<GoldenCase>& cases, std::string& error, const std::string& romDirectory)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		error = "Failed to open manifest: " + path;
+		return false;
+	}
+
+	size_t slash = path.find_last_of("/\\");
+	std::string directory = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+	std::string roms = directory;
+	if (!romDirectory.empty())
+	{
+		roms = romDirectory;
+		if (roms.back() != '/' && roms.back() != '\\') roms += '/';
+	}
+
+	std::string line;
+	for (unsigned int lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+
+		std::istringstream fields(line);
+		std::string rom;
+		if (!(fields >> rom)) continue; // blank line
+
+		GoldenCase test;
+		test.name = rom;
+		test.rom = roms + rom;
+		if (!(fields >> test.frames))
+		{
+			error = path + ":" + std::to_string(lineNumber) + ": expected a frame count after " + rom;
+			return false;
+		}
+
+		std::string field;
+		while (fields >> field)
+		{
+			if (ParseVariant(field, test.variant))
+			{
+				test.hasVariant = true;
+				test.name += "." + field;
+			}
+			else if (field.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos)
+			{
+				test.keys = field;
+			}
+			else
+			{
+				error = path + ":" + std::to_string(lineNumber) + ": unknown field " + field;
+				return false;
+			}
+		}
+		test.golden = directory + test.name + ".golden";
+		cases.push_back(test);
+	}
+	return true;
+}
+
+bool RunGoldenCase(const GoldenCase& test, std::string& state, std::string& error)
+{
+	std::shared_ptr<const RomImage> rom = LoadRomImage(test.rom, error);
+	if (!rom) return false;
+
+	Chip8 chip8;
+	chip8.LoadROM(*rom);
+	if (test.hasVariant) chip8.variant = test.variant;
+	for (char key : test.keys)
+	{
+		chip8.SetKey(static_cast<uint8_t>(std::stoul(std::string(1, key), nullptr, 16)), true);
+	}
+
+	for (unsigned int frame = 0; frame < test.frames && !chip8.halted; ++frame)
+	{
+		chip8.Run<false>(chip8.hires ? GOLDEN_CYCLES_PER_FRAME * 4 : GOLDEN_CYCLES_PER_FRAME);
+		chip8.TickTimers();
+	}
+
+	// Everything a behaviour change could plausibly show up in
+	std::ostringstream out;
+	out << std::hex << std::setfill('0');
+	out << "variant " << VariantName(chip8.variant) << "\n";
+	out << "display " << std::setw(16) << HashRom(reinterpret_cast<const uint8_t*>(chip8.display), sizeof(chip8.display))
+		<< (chip8.hires ? " hires" : " lores") << " planes " << std::setw(1) << (int)chip8.planeMask << "\n";
+	out << "pc " << std::setw(4) << chip8.pc << " i " << std::setw(4) << chip8.index << "\n";
+	out << "v";
+	for (unsigned int r = 0; r < REGISTER_COUNT; ++r) out << " " << std::setw(2) << (int)chip8.registers[r];
+	out << "\n";
+	out << "dt " << std::setw(2) << (int)chip8.delayTimer << " st " << std::setw(2) << (int)chip8.soundTimer << "\n";
+	out << "stack";
+	for (unsigned int s = 0; s < chip8.sp && s < STACK_SIZE; ++s) out << " " << std::setw(4) << chip8.stack[s];
+	out << "\n";
+	out << "flags";
+	for (unsigned int r = 0; r < FLAG_REGISTER_COUNT; ++r) out << " " << std::setw(2) << (int)chip8.flagRegisters[r];
+	out << "\n";
+	out << "audio " << std::setw(2) << (int)chip8.audioPitch << " ";
+	for (unsigned int b = 0; b < AUDIO_PATTERN_SIZE; ++b) out << std::setw(2) << (int)chip8.audioPattern[b];
+	out << "\n";
+	std::vector<uint8_t> memory(MEMORY_SIZE);
+	chip8.memory.Copy(0, memory.data(), memory.size());
+	out << "memory " << std::setw(16) << HashRom(memory.data(), memory.size()) << "\n";
+
+	state = out.str();
+	return true;
+}
+
+int RunGoldenSuite(const std::vector<GoldenCase>& cases, bool update, unsigned int threads)
+{
+	struct Result
+	{
+		bool passed = false;
+		std::string message;
+	};
+	std::vector<Result> results(cases.size());
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Each worker takes the next case until none are left
+	std::atomic<size_t> next{0};
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < cases.size(); i = next++)
+		{
+			const GoldenCase& test = cases[i];
+			Result& result = results[i];
+			std::string state, error;
+
+			if (!RunGoldenCase(test, state, error))
+			{
+				result.message = error;
+				continue;
+			}
+
+			if (update)
+			{
+				std::ofstream file(test.golden, std::ios::trunc);
+				file << state;
+				result.passed = static_cast<bool>(file);
+				result.message = result.passed ? "updated" : "failed to write " + test.golden;
+				continue;
+			}
+
+			std::ifstream file(test.golden);
+			if (!file)
+			{
+				result.message = "no golden file (run with --update)";
+				continue;
+			}
+			std::stringstream expected;
+			expected << file.rdbuf();
+
+			if (expected.str() == state)
+			{
+				result.passed = true;
+				continue;
+			}
+
+			// Show the lines that differ
+			std::istringstream want(expected.str()), got(state);
+			std::string wantLine, gotLine;
+			while (true)
+			{
+				bool moreWant = static_cast<bool>(std::getline(want, wantLine));
+				bool moreGot = static_cast<bool>(std::getline(got, gotLine));
+				if (!moreWant && !moreGot) break;
+				if (!moreWant) wantLine.clear();
+				if (!moreGot) gotLine.clear();
+				if (wantLine != gotLine)
+				{
+					result.message += "\n    expected: " + wantLine + "\n    got:      " + gotLine;
+				}
+			}
+		}
+	};
+
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < threads && t < cases.size(); ++t) pool.emplace_back(worker);
+	worker();
+	for (std::thread& thread : pool) thread.join();
+
+	int failures = 0;
+	for (size_t i = 0; i < cases.size(); ++i)
+	{
+		std::cout << (results[i].passed ? "PASS " : "FAIL ") << cases[i].name;
+		if (!results[i].message.empty()) std::cout << (results[i].message[0] == '\n' ? "" : ": ") << results[i].message;
+		std::cout << std::endl;
+		if (!results[i].passed) ++failures;
+	}
+
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << cases.size() - failures << "/" << cases.size() << " passed in " << elapsed << "ms" << std::endl;
+	return failures;
+}
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "chip8.h"
+#include "capture.h"
+#include "debugger.h"
+#include "gdb_stub.h"
+#include "metrics.h"
+#include "rom.h"
+#include "golden.h"
+#include "analysis.h"
+#include "explorer.h"
+#include "trace.h"
+
+// Runs a ROM without a window or audio: a fixed number of 60Hz frames, as fast
+// as the host allows, optionally capturing every frame or the last one.
+
+static void PrintUsage(const char* program)
+{
+	std::cout << "Usage: " << program << " <ROM file> [options]" << std::endl;
+	std::cout << "  --frames N         60Hz frames to run (default: 600)" << std::endl;
+	std::cout << "  --cycles N         Instructions per frame, x4 in hi-res (default: 12)" << std::endl;
+	std::cout << "  --vip-timing       Run each frame as a COSMAC VIP machine-cycle budget instead of --cycles instructions" << std::endl;
+	std::cout << "  --seed N           Seed for CXNN's generator (default: a fixed seed, so runs repeat)" << std::endl;
+	std::cout << "  --variant NAME     chip8, schip or xochip (default: detected from the ROM)" << std::endl;
+	std::cout << "  --png DIR          Capture every frame as a PNG sequence" << std::endl;
+	std::cout << "  --raw DIR          Capture every frame as raw RGBA files (128x64 times the scale)" << std::endl;
+	std::cout << "  --pipe COMMAND     Stream raw RGBA frames (128x64 times the scale) to COMMAND's stdin" << std::endl;
+	std::cout << "  --screenshot FILE  Save the final frame as a PNG" << std::endl;
+	std::cout << "  --scale N          Output pixels per hi-res pixel for captures and screenshots (default: 1)" << std::endl;
+	std::cout << "  --palette COLOURS  Comma-separated RRGGBB colours, background first (default: white on black)" << std::endl;
+	std::cout << "  --gdb PORT|PATH    Wait for GDB on a localhost TCP port or UNIX socket before running" << std::endl;
+	std::cout << "  --metrics FILE     Export metrics every interval (JSON lines for .json/.jsonl, else Prometheus text)" << std::endl;
+	std::cout << "  --metrics-interval MS  Metrics export interval (default: 1000)" << std::endl;
+	std::cout << "  --trace FILE       Write the last frames' phases as Chrome trace-event JSON" << std::endl;
+	std::cout << "  --analyse          Print the recovered control flow as an assembler listing instead of running" << std::endl;
+	std::cout << "   or: " << program << " --golden <manifest> [--roms DIR] [--case NAME] [--update]" << std::endl;
+	std::cout << "  Run every case in the manifest and compare the end state with its golden file" << std::endl;
+	std::cout << "  --roms DIR         Directory the manifest's ROMs are in (default: the manifest's)" << std::endl;
+	std::cout << "  --case NAME        Run only this case: its ROM as listed, plus .VARIANT if the case names one" << std::endl;
+	std::cout << "  --update           Write the golden files instead of comparing" << std::endl;
+	std::cout << "   or: " << program << " --explore <ROM file> [options]" << std::endl;
+	std::cout << "  Search keypad inputs for sequences that reach new code, printing each one found" << std::endl;
+	std::cout << "  --depth N          Steps to search (default: 60)" << std::endl;
+	std::cout << "  --beam N           States kept per step, most new code first; 0 keeps all (default: 256)" << std::endl;
+	std::cout << "  --step-frames N    Frames each input is held for (default: 4)" << std::endl;
+	std::cout << "  --keys LIST        Comma-separated inputs to try, each hex keys held together or - for none" << std::endl;
+	std::cout << "                     (default: -,0,1,...,F)" << std::endl;
+	std::cout << "  --threads N        Worker threads (default: one per core)" << std::endl;
+	std::cout << "  --max-states N     Visited-state table size (default: 4194304)" << std::endl;
+	std::cout << "  --cycles, --seed and --variant as above" << std::endl;
+}
+
+// Static listing of the ROM: labels at block starts, instructions, and DB lines for data.
+// Output is valid chip8_asm input.
+static void PrintListing(const Chip8& chip8, size_t romSize)
+{
+	// The analysis reads memory as one flat array
+	std::vector<uint8_t> memory(MEMORY_SIZE);
+	chip8.memory.Copy(0, memory.data(), memory.size());
+
+	ProgramAnalysis analysis;
+	auto start = std::chrono::high_resolution_clock::now();
+	analysis.Analyse(memory.data(), chip8.variant);
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "; " << analysis.Blocks().size() << " blocks, " << analysis.Subroutines().size() - 1 << " subroutines, "
+		<< analysis.LoopCount() << " loops (" << elapsed << "ms)" << std::endl;
+
+	char line[64];
+	uint32_t end = PC_START_ADDRESS + romSize;
+	for (uint32_t addr = PC_START_ADDRESS; addr < end; ) {
+		std::string label = analysis.Label(addr);
+		if (!label.empty()) std::cout << label << ":" << std::endl;
+
+		ProgramAnalysis::ByteKind kind = analysis.Kind(addr);
+		if (kind != ProgramAnalysis::CODE || addr + 1 >= end) {
+			// Data, or bytes no path reaches
+			std::snprintf(line, sizeof(line), "\tDB 0x%02X\t\t; %03X%s", memory[addr], addr, kind == ProgramAnalysis::DATA ? "" : " unreached");
+			std::cout << line << std::endl;
+			addr++;
+			continue;
+		}
+
+		uint16_t opcode = memory[addr] << 8 | memory[addr + 1];
+		unsigned int length = ProgramAnalysis::InstructionLength(memory.data(), addr, chip8.variant);
+		std::snprintf(line, sizeof(line), "\t%-24s; %03X", Chip8::Disassemble(opcode).c_str(), addr);
+		std::cout << line << std::endl;
+		if (length == 4) {
+			std::snprintf(line, sizeof(line), "\tDW 0x%04X", memory[addr + 2] << 8 | memory[addr + 3]);
+			std::cout << line << std::endl;
+		}
+		addr += length;
+	}
+}
+
+// Parse "-,5,4A" into keypad states
+static bool ParseInputs(const std::string& text, std::vector<uint16_t>& inputs)
+{
+	std::istringstream list(text);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		uint16_t keys = 0;
+		if (item != "-") {
+			if (item.empty() || item.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) return false;
+			for (char key : item) keys |= 1 << std::stoul(std::string(1, key), nullptr, 16);
+		}
+		inputs.push_back(keys);
+	}
+	return !inputs.empty();
+}
+
+static int RunExplore(int argc, char* argv[])
+{
+	ExploreOptions options;
+	std::string variantName;
+	std::string seedText;
+	for (int i = 3; i < argc; ++i) {
+		std::string option = argv[i];
+		if (i + 1 >= argc) {
+			std::cout << "Missing value for " << option << std::endl;
+			return 1;
+		}
+		std::string value = argv[++i];
+
+		if (option == "--depth") options.depth = std::stoul(value);
+		else if (option == "--beam") options.beam = std::stoul(value);
+		else if (option == "--step-frames") options.stepFrames = std::max(1ul, std::stoul(value));
+		else if (option == "--cycles") options.cyclesPerFrame = std::stoul(value);
+		else if (option == "--threads") options.threads = std::stoul(value);
+		else if (option == "--max-states") options.maxStates = std::stoull(value);
+		else if (option == "--seed") seedText = value;
+		else if (option == "--variant") variantName = value;
+		else if (option == "--keys") {
+			if (!ParseInputs(value, options.inputs)) {
+				std::cout << "Bad key list: " << value << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::cout << "Unknown option: " << option << std::endl;
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::string error;
+	std::shared_ptr<const RomImage> rom = LoadRomImage(argv[2], error);
+	if (!rom) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+
+	Chip8 chip8;
+	chip8.LoadROM(*rom);
+	if (!seedText.empty()) {
+		chip8.random.Seed(std::stoull(seedText, nullptr, 0));
+	}
+	if (!variantName.empty() && !ParseVariant(variantName, chip8.variant)) {
+		std::cout << "Unknown variant: " << variantName << std::endl;
+		return 1;
+	}
+
+	ExploreResult result = Explore(chip8, options);
+
+	char address[8];
+	for (const ExploreDiscovery& discovery : result.discoveries) {
+		std::snprintf(address, sizeof(address), "%03X", discovery.addresses.front());
+		std::cout << "step " << discovery.inputs.size() << ": +" << discovery.addresses.size() << " from " << address
+			<< ": " << FormatInputs(discovery.inputs) << std::endl;
+	}
+
+	float minutes = result.elapsedMs / 60000.0f;
+	std::cout << argv[2] << ": " << result.depth << " steps, " << result.expanded << " states run, " << result.unique << " distinct, "
+		<< result.covered << " instruction addresses reached in " << result.elapsedMs << "ms ("
+		<< static_cast<uint64_t>(minutes > 0 ? result.expanded / minutes : 0) << " states/minute)" << std::endl;
+	if (result.tableFull) std::cout << "Stopped early: the visited-state table is full (--max-states)" << std::endl;
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	// Start-up is measured from here to the end of the first frame
+	auto startupTime = std::chrono::high_resolution_clock::now();
+
+	if (argc < 2) {
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	// Golden-state regression run
+	if (std::string(argv[1]) == "--golden") {
+		if (argc < 3) {
+			PrintUsage(argv[0]);
+			return 1;
+		}
+
+		std::string romDirectory;
+		std::string only;
+		bool update = false;
+		for (int i = 3; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--roms" && i + 1 < argc) {
+				romDirectory = argv[++i];
+			} else if (arg == "--case" && i + 1 < argc) {
+				only = argv[++i];
+			} else if (arg == "--update") {
+				update = true;
+			} else {
+				std::cout << "Unknown option: " << arg << std::endl;
+				PrintUsage(argv[0]);
+				return 1;
+			}
+		}
+
+		std::vector<GoldenCase> cases;
+		std::string error;
+		if (!LoadGoldenManifest(argv[2], cases, error, romDirectory)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+
+		if (!only.empty()) {
+			cases.erase(std::remove_if(cases.begin(), cases.end(), [&](const GoldenCase& test) { return test.name != only; }), cases.end());
+			if (cases.empty()) {
+				std::cout << "No case named " << only << " in " << argv[2] << std::endl;
+				return 1;
+			}
+		}
+
+		return RunGoldenSuite(cases, update) == 0 ? 0 : 1;
+	}
+
+	// Input search
+	if (std::string(argv[1]) == "--explore") {
+		if (argc < 3) {
+			PrintUsage(argv[0]);
+			return 1;
+		}
+		return RunExplore(argc, argv);
+	}
+
+	std::string romPath = argv[1];
+	unsigned int frames = 600;
+	unsigned int cyclesPerFrame = 12;
+	std::string variantName;
+	std::string captureTarget;
+	CaptureFormat captureFormat = CaptureFormat::Png;
+	std::string screenshotPath;
+	ScaleOptions scaleOptions;
+	std::string paletteText;
+	bool analyse = false;
+	bool vipTiming = false;
+	std::string gdbAddress;
+	std::string seedText;
+	std::string metricsPath;
+	unsigned int metricsInterval = 1000;
+	std::string tracePath;
+
+	for (int i = 2; i < argc; ++i) {
+		std::string option = argv[i];
+		if (option == "--analyse") {
+			analyse = true;
+			continue;
+		}
+		if (option == "--vip-timing") {
+			vipTiming = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			std::cout << "Missing value for " << option << std::endl;
+			return 1;
+		}
+		std::string value = argv[++i];
+
+		if (option == "--frames") frames = std::stoul(value);
+		else if (option == "--cycles") cyclesPerFrame = std::stoul(value);
+		else if (option == "--variant") variantName = value;
+		else if (option == "--seed") seedText = value;
+		else if (option == "--png") { captureFormat = CaptureFormat::Png; captureTarget = value; }
+		else if (option == "--raw") { captureFormat = CaptureFormat::Raw; captureTarget = value; }
+		else if (option == "--pipe") { captureFormat = CaptureFormat::Pipe; captureTarget = value; }
+		else if (option == "--screenshot") screenshotPath = value;
+		else if (option == "--scale") scaleOptions.scale = std::max(1ul, std::stoul(value));
+		else if (option == "--palette") paletteText = value;
+		else if (option == "--gdb") gdbAddress = value;
+		else if (option == "--metrics") metricsPath = value;
+		else if (option == "--metrics-interval") metricsInterval = std::stoul(value);
+		else if (option == "--trace") tracePath = value;
+		else {
+			std::cout << "Unknown option: " << option << std::endl;
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::string error;
+	if (!paletteText.empty() && !ParsePalette(paletteText, scaleOptions.palette, error)) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+
+	std::shared_ptr<const RomImage> rom = LoadRomImage(romPath, error);
+	if (!rom) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+
+	Chip8 chip8;
+	chip8.LoadROM(*rom);
+	if (!seedText.empty()) {
+		chip8.random.Seed(std::stoull(seedText, nullptr, 0));
+	}
+
+	if (!variantName.empty() && !ParseVariant(variantName, chip8.variant)) {
+		std::cout << "Unknown variant: " << variantName << std::endl;
+		return 1;
+	}
+
+	if (analyse) {
+		PrintListing(chip8, rom->data.size());
+		return 0;
+	}
+
+	FrameCapture capture;
+	if (!captureTarget.empty() && !capture.Start(captureFormat, captureTarget, scaleOptions, error)) {
+		std::cout << error << std::endl;
+		return 1;
+	}
+
+	Debugger debugger;
+	GdbStub gdb;
+	if (!gdbAddress.empty()) {
+		if (!gdb.Start(gdbAddress, true, error)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		std::cout << "Waiting for GDB on " << gdbAddress << std::endl;
+	}
+
+	Metrics metrics;
+	MetricsExporter metricsExporter;
+	if (!metricsPath.empty()) {
+		size_t dot = metricsPath.rfind('.');
+		bool json = dot != std::string::npos && (metricsPath.substr(dot) == ".json" || metricsPath.substr(dot) == ".jsonl");
+		if (!metricsExporter.Start(metrics, json ? MetricsFormat::JsonLines : MetricsFormat::Prometheus, metricsPath, metricsInterval, error)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+	}
+
+	if (!tracePath.empty()) {
+		Trace::NameThread("Main");
+		Trace::SetEnabled(true);
+	}
+
+	// Same pacing as the GUI: hi-res programs expect a faster interpreter
+	auto start = std::chrono::high_resolution_clock::now();
+	uint64_t instructions = 0;
+	unsigned int frame = 0;
+	auto frameStart = start;
+	for (; frame < frames && !chip8.halted; ++frame) {
+		TraceZone frameZone("Frame");
+		if (!gdbAddress.empty()) {
+			// Time stands still while the debugger has the machine stopped
+			gdb.Service(chip8, debugger, vipTiming);
+			while (gdb.IsStopped()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				gdb.Service(chip8, debugger, vipTiming);
+			}
+		}
+
+		// With VIP timing a frame is a budget of machine cycles, and the machine ticks its own timers
+		int cycles = chip8.hires ? cyclesPerFrame * 4 : cyclesPerFrame;
+		uint64_t frameEndCycle = (uint64_t)(frame + 1) * VIP_CYCLES_PER_FRAME;
+		int executed;
+		{
+			TraceZone zone("Chip8::Run");
+			if (debugger.IsActive()) {
+				executed = vipTiming ? chip8.RunTimed<true>(frameEndCycle, &debugger) : chip8.Run<true>(cycles, &debugger);
+				if (debugger.ConsumeHit()) {
+					gdb.ReportBreak();
+				}
+			}
+			else {
+				executed = vipTiming ? chip8.RunTimed<false>(frameEndCycle) : chip8.Run<false>(cycles);
+			}
+			if (!vipTiming) {
+				chip8.TickTimers();
+			}
+		}
+		instructions += executed;
+
+		// Nothing is waiting on us, so wait for the encoder rather than drop frames
+		if (capture.IsActive()) {
+			TraceZone zone("FrameCapture::Submit");
+			capture.Submit(chip8, true);
+		}
+
+		Metrics::Add(metrics.instructions, executed);
+		Metrics::Add(metrics.framesEmulated, 1);
+		if (frame == 0) {
+			metrics.firstFrameMicros.store(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::high_resolution_clock::now() - startupTime).count()), std::memory_order_relaxed);
+		}
+		if (metricsExporter.IsActive()) {
+			// Only read the clock when someone is looking: a headless frame is far shorter than a clock read is cheap
+			auto frameEnd = std::chrono::high_resolution_clock::now();
+			metrics.RecordFrameTime(frameEnd - frameStart);
+			frameStart = frameEnd;
+			metrics.captureQueued.store(static_cast<uint32_t>(capture.Queued()), std::memory_order_relaxed);
+		}
+	}
+	capture.Stop();
+	metrics.framesDropped.store(capture.Dropped(), std::memory_order_relaxed);
+	metricsExporter.Stop();
+	gdb.Stop();
+	float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (!screenshotPath.empty() && !FrameCapture::WritePng(screenshotPath, chip8.display, chip8.hires, scaleOptions)) {
+		std::cout << "Failed to write screenshot: " << screenshotPath << std::endl;
+		return 1;
+	}
+
+	// End-state fingerprint, for comparing batch runs (same ROM, seed and options: same hash)
+	char stateHash[24];
+	std::snprintf(stateHash, sizeof(stateHash), "%016llx", static_cast<unsigned long long>(chip8.StateHash()));
+	std::cout << "State " << stateHash << std::endl;
+
+	std::cout << romPath << " (" << VariantName(chip8.variant) << "): " << frame << " frames, "
+		<< instructions << " instructions in " << elapsed << "ms, first frame after "
+		<< metrics.firstFrameMicros.load(std::memory_order_relaxed) / 1000.0 << "ms" << std::endl;
+	if (!captureTarget.empty()) {
+		std::cout << "Captured " << capture.Written() << " frames, dropped " << capture.Dropped() << std::endl;
+	}
+
+	if (!tracePath.empty()) {
+		if (!Trace::Export(tracePath, error)) {
+			std::cout << error << std::endl;
+			return 1;
+		}
+		std::cout << "Saved trace to " << tracePath << std::endl;
+	}
+
+	return 0;
+}
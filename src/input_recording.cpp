@@ -0,0 +1,60 @@
+#include "input_recording.h"
+#include "chip8.h"
+
+void InputRecording::Clear(const Chip8& chip8, bool vipTiming)
+{
+	randomState = chip8.random.state;
+	timed = vipTiming;
+	events.clear();
+	cycle = 0;
+	frames = 0;
+}
+
+void InputRecording::Tick()
+{
+	events.push_back({ cycle, TICK, 0 });
+	++frames;
+}
+
+void InputRecording::Key(uint8_t key, bool pressed)
+{
+	events.push_back({ cycle, pressed ? KEY_DOWN : KEY_UP, static_cast<uint8_t>(key & 0xF) });
+}
+
+// Run up to `target` instructions in. If the machine stops short (idle loop,
+// display wait, halted) it stopped short live too: nothing can happen until the next event.
+// A timed run just runs to the machine cycle.
+static uint64_t RunTo(Chip8& chip8, bool timed, uint64_t executed, uint64_t target)
+{
+	if (timed)
+	{
+		chip8.RunTimed<false>(target);
+		return target;
+	}
+
+	while (executed < target)
+	{
+		uint64_t remaining = target - executed;
+		int ran = chip8.Run<false>(remaining > 10000 ? 10000 : static_cast<int>(remaining));
+		if (ran == 0) break;
+		executed += ran;
+	}
+	return executed;
+}
+
+void InputRecording::Replay(Chip8& chip8) const
+{
+	chip8.random.state = randomState;
+	uint64_t executed = 0;
+	for (const Event& event : events)
+	{
+		executed = RunTo(chip8, timed, executed, event.cycle);
+		switch (event.type)
+		{
+			case TICK:     chip8.TickTimers(); break;
+			case KEY_DOWN: chip8.SetKey(event.key, true); break;
+			case KEY_UP:   chip8.SetKey(event.key, false); break;
+		}
+	}
+	RunTo(chip8, timed, executed, cycle);
+}
@@ -1,12 +1,127 @@
 #include "chip8.h"
 
-// Clear screen
+// Clear screen (the selected planes)
 void Chip8::OP_00E0()
 {
-	for(int i = 0; i < DISPLAY_SIZE; ++i)
+	++writeCount;
+	for(unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
 	{
-		display[i] = 0x00000000; // Black pixels
+		if (!(planeMask & (1 << plane))) continue;
+		for(unsigned int row = 0; row < DISPLAY_HEIGHT; ++row)
+		{
+			for(unsigned int word = 0; word < DISPLAY_ROW_WORDS; ++word)
+			{
+				display[plane][row][word] = 0; // Black pixels
+			}
+		}
+#ifdef CHIP8_STATE_HASH
+		displayHash[plane] = 0;
+#endif
+	}
+}
+
+// Return from subroutine
+void Chip8::OP_00EE()
+{
+	sp = (sp - 1) & (STACK_SIZE - 1);
+	pc = stack[sp];
+}
+
+// Scroll down N rows: move whole rows, clear the ones scrolled in at the top
+void Chip8::OP_00CN(uint8_t rows)
+{
+	++writeCount;
+	unsigned int height = DisplayHeight();
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planeMask & (1 << plane))) continue;
+		for (int row = height - 1; row >= 0; --row)
+		{
+			for (unsigned int word = 0; word < DISPLAY_ROW_WORDS; ++word)
+			{
+				display[plane][row][word] = (row >= rows) ? display[plane][row - rows][word] : 0;
+			}
+		}
 	}
+	RehashDisplay(planeMask);
+}
+
+// Scroll up N rows
+void Chip8::OP_00DN(uint8_t rows)
+{
+	++writeCount;
+	unsigned int height = DisplayHeight();
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planeMask & (1 << plane))) continue;
+		for (unsigned int row = 0; row < height; ++row)
+		{
+			for (unsigned int word = 0; word < DISPLAY_ROW_WORDS; ++word)
+			{
+				display[plane][row][word] = (row + rows < height) ? display[plane][row + rows][word] : 0;
+			}
+		}
+	}
+	RehashDisplay(planeMask);
+}
+
+// Scroll right 4 pixels: a 128-bit shift across the two words of a hi-res row,
+// a 64-bit shift of word 0 in lo-res
+void Chip8::OP_00FB()
+{
+	++writeCount;
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planeMask & (1 << plane))) continue;
+		for (unsigned int row = 0; row < DISPLAY_HEIGHT; ++row)
+		{
+			uint64_t* words = display[plane][row];
+			if (hires) words[1] = (words[1] >> 4) | (words[0] << 60);
+			words[0] >>= 4;
+		}
+	}
+	RehashDisplay(planeMask);
+}
+
+// Scroll left 4 pixels
+void Chip8::OP_00FC()
+{
+	++writeCount;
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		if (!(planeMask & (1 << plane))) continue;
+		for (unsigned int row = 0; row < DISPLAY_HEIGHT; ++row)
+		{
+			uint64_t* words = display[plane][row];
+			words[0] = (words[0] << 4) | (hires ? words[1] >> 60 : 0);
+			if (hires) words[1] <<= 4;
+		}
+	}
+	RehashDisplay(planeMask);
+}
+
+// Exit: stop executing until reset
+void Chip8::OP_00FD()
+{
+	halted = true;
+	pc -= 2;
+}
+
+// Switch resolution. Both modes share the framebuffer, so clear all planes.
+void Chip8::OP_00FE()
+{
+	++writeCount;
+	hires = false;
+	for (auto& plane : display) for (auto& row : plane) for (auto& word : row) word = 0;
+	RehashDisplay(0xF);
+}
+
+void Chip8::OP_00FF()
+{
+	++writeCount;
+	hires = true;
+	for (auto& plane : display) for (auto& row : plane) for (auto& word : row) word = 0;
+	RehashDisplay(0xF);
 }
 
 // Jump
@@ -15,6 +130,34 @@ void Chip8::OP_1NNN(uint16_t address)
 	pc = address;
 }
 
+// Call subroutine: push the return address and jump
+void Chip8::OP_2NNN(uint16_t address)
+{
+	stack[sp] = pc;
+	sp = (sp + 1) & (STACK_SIZE - 1);
+	pc = address;
+}
+
+// Store VX..VY at I (either direction), I unchanged
+void Chip8::OP_5XY2(uint8_t Vx, uint8_t Vy){
+	int step = Vx <= Vy ? 1 : -1;
+	for (int i = 0, reg = Vx; ; ++i, reg += step)
+	{
+		Write(index + i, registers[reg]);
+		if (reg == Vy) break;
+	}
+}
+
+// Load VX..VY from I (either direction), I unchanged
+void Chip8::OP_5XY3(uint8_t Vx, uint8_t Vy){
+	int step = Vx <= Vy ? 1 : -1;
+	for (int i = 0, reg = Vx; ; ++i, reg += step)
+	{
+		registers[reg] = Read(index + i);
+		if (reg == Vy) break;
+	}
+}
+
 // Set register VX
 void Chip8::OP_6XNN(uint8_t Vx, uint8_t byte){
 	registers[Vx] = byte;
@@ -25,56 +168,133 @@ void Chip8::OP_7XNN(uint8_t Vx, uint8_t byte){
 	registers[Vx] += byte;
 }
 
+// VX = VY
+void Chip8::OP_8XY0(uint8_t Vx, uint8_t Vy){
+	registers[Vx] = registers[Vy];
+}
+
+// The flag is written after the result, so VF as an operand ends up holding the flag
+
+// VX += VY, VF = carry
+void Chip8::OP_8XY4(uint8_t Vx, uint8_t Vy){
+	uint16_t sum = registers[Vx] + registers[Vy];
+	registers[Vx] = sum & 0xFF;
+	registers[0xF] = sum > 0xFF;
+}
+
+// VX -= VY, VF = not borrow
+void Chip8::OP_8XY5(uint8_t Vx, uint8_t Vy){
+	uint8_t notBorrow = registers[Vx] >= registers[Vy];
+	registers[Vx] -= registers[Vy];
+	registers[0xF] = notBorrow;
+}
+
+// VX = VY - VX, VF = not borrow
+void Chip8::OP_8XY7(uint8_t Vx, uint8_t Vy){
+	uint8_t notBorrow = registers[Vy] >= registers[Vx];
+	registers[Vx] = registers[Vy] - registers[Vx];
+	registers[0xF] = notBorrow;
+}
+
 // Set index register
 void Chip8::OP_ANNN(uint16_t address){
 	index = address;
 }
 
-// Display/Draw
-void Chip8::OP_DXYN(uint8_t Vx, uint8_t Vy, uint8_t height){
-	// Draws a sprite at coordinate (VX, VY) that has a width of 8 pixels and a height of N pixels.
-	// index register points to the location in memory where the sprite's data is stored.
-	// All the pixels are XORed onto the existing screen.
+// VX = random byte & NN, from the machine's own generator
+void Chip8::OP_CXNN(uint8_t Vx, uint8_t byte){
+	registers[Vx] = random.NextByte() & byte;
+}
 
-	// Get coordinates from registers and wrap around if going beyond screen boundaries
-	uint8_t xPos = registers[Vx] % DISPLAY_WIDTH;
-	uint8_t yPos = registers[Vy] % DISPLAY_HEIGHT;
+// I = the 16-bit address following this instruction
+void Chip8::OP_F000(){
+	index = Read(pc) << 8 | Read(pc + 1);
+	pc += 2;
+}
 
-	*VF = 0; // reset collision flag
+// Select drawing planes
+void Chip8::OP_FN01(uint8_t mask){
+	planeMask = mask & ((1 << DISPLAY_PLANES) - 1);
+}
 
-	// For each row of the sprite
-	for(unsigned int row = 0; row < height; ++row)
+// Load 16 bytes of audio pattern from I
+void Chip8::OP_F002(){
+	for (unsigned int i = 0; i < AUDIO_PATTERN_SIZE; ++i)
 	{
-		// Stop if we reach the bottom of the screen
-		if((yPos + row) >= DISPLAY_HEIGHT) break;
+		audioPattern[i] = Read(index + i);
+	}
+}
 
-		// Get the sprite byte for this row
-		uint8_t spriteByte = memory[index + row];
+// Audio playback pitch = VX
+void Chip8::OP_FX3A(uint8_t Vx){
+	audioPitch = registers[Vx];
+}
 
-		// For each bit in the sprite byte (8 pixels wide)
-		for(unsigned int col = 0; col < 8; ++col)
-		{
-			// Stop if we reach the right edge of the screen
-			if((xPos + col) >= DISPLAY_WIDTH) break;
+// VX = delay timer
+void Chip8::OP_FX07(uint8_t Vx){
+	registers[Vx] = delayTimer;
+}
 
-			// Extract the pixel value (1 or 0) from the sprite byte
-			uint8_t spritePixel = spriteByte & (0x80 >> col);
-			
-			// Calculate screen pixel position
-			uint32_t* screenPixel = &display[(yPos + row) * DISPLAY_WIDTH + (xPos + col)];
+// Wait for a key press: repeat this instruction until one is down (the lowest, if several are)
+void Chip8::OP_FX0A(uint8_t Vx){
+	if (keypad)
+	{
+		uint8_t key = 0;
+		while (!((keypad >> key) & 1)) ++key;
+		registers[Vx] = key;
+		return;
+	}
+	pc -= 2;
 
-			// If sprite pixel is on (1)
-			if(spritePixel)
-			{
-				// Check for collision (both sprite and screen pixels are on)
-				if(*screenPixel == 0xFFFFFFFF)
-				{
-					*VF = 1; // Set collision flag
-				}
-
-				// XOR the pixel (toggle it)
-				*screenPixel ^= 0xFFFFFFFF;
-			}
-		}
+	// Nothing changes until a key does
+	idle = true;
+}
+
+// Delay timer = VX
+void Chip8::OP_FX15(uint8_t Vx){
+	delayTimer = registers[Vx];
+}
+
+// Sound timer = VX
+void Chip8::OP_FX18(uint8_t Vx){
+	soundTimer = registers[Vx];
+}
+
+// I += VX
+void Chip8::OP_FX1E(uint8_t Vx){
+	index += registers[Vx];
+}
+
+// I = address of the font character for the low nibble of VX
+void Chip8::OP_FX29(uint8_t Vx){
+	index = FONT_START_ADDRESS + (registers[Vx] & 0xF) * 5;
+}
+
+// I = address of the big font character for the low nibble of VX
+void Chip8::OP_FX30(uint8_t Vx){
+	index = BIG_FONT_START_ADDRESS + (registers[Vx] & 0xF) * 10;
+}
+
+// Store the decimal digits of VX at I, I+1, I+2
+void Chip8::OP_FX33(uint8_t Vx){
+	uint8_t value = registers[Vx];
+	Write(index,     value / 100);
+	Write(index + 1, (value / 10) % 10);
+	Write(index + 2, value % 10);
+}
+
+// Save V0..VX to the flag registers
+void Chip8::OP_FX75(uint8_t Vx){
+	for (unsigned int i = 0; i <= Vx; ++i)
+	{
+		flagRegisters[i] = registers[i];
+	}
+}
+
+// Load V0..VX from the flag registers
+void Chip8::OP_FX85(uint8_t Vx){
+	for (unsigned int i = 0; i <= Vx; ++i)
+	{
+		registers[i] = flagRegisters[i];
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,26 @@
+#include "key_events.h"
+#include <cmath>
+
+void KeyEventQueue::Push(uint8_t key, bool pressed, Clock::time_point time)
+{
+	// Events come from one source in order, but keep the queue sorted so a late stamp can't apply early
+	Event event{ time, static_cast<uint8_t>(key & 0xF), pressed };
+	auto it = events.end();
+	while (it != events.begin() && (it - 1)->time > time) --it;
+	events.insert(it, event);
+}
+
+KeyEventQueue::Event KeyEventQueue::Pop()
+{
+	Event event = events.front();
+	events.pop_front();
+	return event;
+}
+
+int KeyEventQueue::InstructionAt(Clock::time_point time, Clock::time_point batchStart, float delay, int cycles)
+{
+	float offset = std::chrono::duration<float, std::chrono::milliseconds::period>(time - batchStart).count();
+	if (offset <= 0 || delay <= 0) return 0;
+	float at = std::ceil(offset / delay);
+	return at >= cycles ? cycles : static_cast<int>(at);
+}
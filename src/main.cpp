@@ -1,13 +1,27 @@
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
 #include <chrono>
+#include <mutex>
 #include <thread>
 #include "chip8.h"
 #include "graphics.h"
+#include "audio.h"
+#include "debugger.h"
+#include "rom.h"
+#include "file_watcher.h"
+#include "input_recording.h"
+#include "gdb_stub.h"
+#include "metrics.h"
+#include "trace.h"
 #include "const.h"
 
 int main(int argc, char* argv[])
 {
+	// Start-up is measured from here to the first emulated and first presented frames
+	auto startupTime = std::chrono::high_resolution_clock::now();
+
 	Chip8 chip8;
 
 	// Debugger handles all rendering and SDL management
@@ -18,12 +32,63 @@ int main(int argc, char* argv[])
 	float cycleDelay = 1.4f; // milliseconds per cycle (700 instructions/second)
 	std::string romPath;
 	bool romLoaded = false;
+
+	// ROM images are read from disk once; resets copy from the cached image
+	RomCache romCache;
+	std::shared_ptr<const RomImage> currentRom;
+	std::string romError;
+
+	// Reload the ROM when it's rebuilt; the recording lets "Replay input" bring the new build back to the same point
+	FileWatcher romWatcher;
+	InputRecording recording;
+
+	// Optional GDB remote stub and metrics export
+	GdbStub gdb;
+	std::string gdbAddress;
+	MetricsExporter metricsExporter;
+	std::string metricsPath;
+	unsigned int metricsInterval = 5000;
+	std::string keyMapPath;
+	std::string seedText;
+	std::string paletteText;
+	std::string tracePath;
+
+	// Flags, then "--name value" options, can go anywhere on the command line; take them out before the positional arguments
+	for (int i = 1; i < argc; ) {
+		if (std::string(argv[i]) == "--vip-timing") {
+			graphics.SetVipTiming(true);
+		} else if (std::string(argv[i]) == "--player") {
+			graphics.SetPlayerMode(true);
+		} else {
+			i++;
+			continue;
+		}
+		for (int j = i; j + 1 <= argc; ++j) argv[j] = argv[j + 1];
+		argc -= 1;
+	}
+
+	for (int i = 1; i + 1 < argc; ) {
+		std::string option = argv[i];
+		std::string value = argv[i + 1];
+		if (option == "--gdb") gdbAddress = value;
+		else if (option == "--metrics") metricsPath = value;
+		else if (option == "--metrics-interval") metricsInterval = std::stoul(value);
+		else if (option == "--keymap") keyMapPath = value;
+		else if (option == "--seed") seedText = value;
+		else if (option == "--palette") paletteText = value;
+		else if (option == "--trace") tracePath = value;
+		else {
+			i++;
+			continue;
+		}
+		for (int j = i; j + 2 <= argc; ++j) argv[j] = argv[j + 2];
+		argc -= 2;
+	}
 	
 	if (argc >= 2) {
 
 		// ROM file specified
 		romPath = argv[1];
-		romLoaded = true;
 
 		// Optional scale and cycle delay
 		if (argc >= 4) {
@@ -35,65 +100,247 @@ int main(int argc, char* argv[])
 		std::cout << "CHIP-8 Emulator with Debugger" << std::endl;
 		std::cout << "Usage: " << argv[0] << " [ROM file] [cycleDelay]" << std::endl;
 		std::cout << "  ROM file: CHIP-8 ROM to load (optional - will show ROM selector if not provided)" << std::endl;
-		std::cout << "  scale: Display scale factor (default: 10)" << std::endl;
+		std::cout << "  scale: Screen pixels per lo-res pixel, rounded down to even (default: 10, shrunk to fit the Display window)" << std::endl;
 		std::cout << "  cycleDelay: Milliseconds per CPU cycle (default: 1.4)" << std::endl;
+		std::cout << "  --gdb PORT|PATH: Accept a GDB remote connection on a localhost port or UNIX socket" << std::endl;
+		std::cout << "  --metrics FILE: Write metrics every 5s, as JSON lines if FILE ends in .json/.jsonl, else Prometheus text" << std::endl;
+		std::cout << "  --metrics-interval MS: Metrics export interval" << std::endl;
+		std::cout << "  --vip-timing: Time instructions and the 60Hz interrupt in COSMAC VIP machine cycles" << std::endl;
+		std::cout << "  --player: Start in player mode: just the display, fullscreen (F11 toggles, Escape leaves)" << std::endl;
+		std::cout << "  --seed N: Seed CXNN's generator with N on every load/reset (default: a new seed each time)" << std::endl;
+		std::cout << "  --palette COLOURS: Display colours as comma-separated RRGGBB, background first" << std::endl;
+		std::cout << "  --keymap FILE: Keypad bindings, one \"<key> <SDL scancode name>[, <name>...]\" line per key" << std::endl;
+		std::cout << "  --trace FILE: Where Save trace writes the frame timeline (default chip8_trace.json); also saved on exit" << std::endl;
 		std::cout << "Starting without ROM - use the ROM selector to load a game..." << std::endl;
 	}
 
+	// Record the main loop's phases from the start; the last few seconds can be saved from the Performance window
+	Trace::NameThread("Main");
+	Trace::SetEnabled(true);
+	if (!tracePath.empty()) {
+		graphics.SetTracePath(tracePath);
+	}
+
+	Metrics& metrics = graphics.GetMetrics();
+	auto sinceStartup = [&]() {
+		return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - startupTime).count());
+	};
+
+	// With VIP timing, the machine cycle the CPU has been given time up to. Batches
+	// run to it rather than by a count, so an instruction that overshoots one batch
+	// comes out of the next.
+	uint64_t vipCycleTarget = 0;
+
+	// Every fresh start seeds CXNN's generator and starts a new input recording, which keeps the seed for replays
+	auto startRun = [&]() {
+		uint64_t seed = seedText.empty() ? std::chrono::high_resolution_clock::now().time_since_epoch().count() : std::stoull(seedText, nullptr, 0);
+		chip8.random.Seed(seed);
+		recording.Clear(chip8, graphics.UseVipTiming());
+		vipCycleTarget = chip8.machineCycles;
+	};
+
+	// Count a run for the recording (instructions, or with VIP timing machine cycles) and the metrics
+	auto countRun = [&](int instructions, uint64_t cyclesBefore) {
+		recording.Executed(graphics.UseVipTiming() ? chip8.machineCycles - cyclesBefore : instructions);
+		Metrics::Add(metrics.instructions, instructions);
+	};
+
+	// Timer runs at 60Hz = 16.67ms per timer tick
+	const float timerInterval = 1000.0f / 60.0f; // ~16.67ms
+
+	// Hi-res (SUPER-CHIP/XO-CHIP) programs are written for much faster interpreters
+	const float hiresSpeedup = 4.0f;
+
+	// Upper bound on instructions (VIP timing: frames) per loop iteration, so a stall (window drag, long pause) doesn't turn into a burst
+	const int maxCyclesPerIteration = 1000;
+	const int maxFramesPerIteration = 4;
+
+	// Load ROM if one was specified; a bad file just leaves us at the ROM selector.
+	// None of this needs the window, so it's done before the UI comes up.
+	if (!romPath.empty()) {
+		currentRom = romCache.Get(romPath, romError);
+		if (currentRom) {
+			chip8.LoadROM(*currentRom);
+			startRun();
+			graphics.SetRomPath(romPath);
+			graphics.AnalyseProgram(chip8);
+			romWatcher.Watch(romPath);
+			romLoaded = true;
+		} else {
+			std::cout << romError << std::endl;
+		}
+	}
+
+	// Start the program now rather than once SDL, the window, the renderer and audio are up, which
+	// can take a good fraction of a second: a helper thread runs it a 60Hz frame at a time until the
+	// main loop takes over. It has the machine to itself until then, and no keys can be down yet.
+	auto timerStart = std::chrono::high_resolution_clock::now();
+	std::mutex startupMutex;
+	std::condition_variable startupWake;
+	bool uiReady = false;
+	std::thread startupRun;
+	if (romLoaded) {
+		startupRun = std::thread([&]() {
+			Trace::NameThread("Start-up run");
+			auto frameEnd = timerStart;
+			std::unique_lock<std::mutex> lock(startupMutex);
+			while (!uiReady) {
+				lock.unlock();
+				{
+					TraceZone zone("Chip8::Run");
+					uint64_t cyclesBefore = chip8.machineCycles;
+					if (graphics.UseVipTiming()) {
+						vipCycleTarget += VIP_CYCLES_PER_FRAME;
+						countRun(chip8.RunTimed<false>(vipCycleTarget), cyclesBefore);
+					} else {
+						float delay = chip8.hires ? cycleDelay / hiresSpeedup : cycleDelay;
+						countRun(chip8.Run<false>(static_cast<int>(timerInterval / delay)), cyclesBefore);
+						chip8.TickTimers();
+						recording.Tick();
+					}
+				}
+				Metrics::Add(metrics.framesEmulated, 1);
+				if (metrics.firstFrameMicros.load(std::memory_order_relaxed) == 0) {
+					metrics.firstFrameMicros.store(sinceStartup(), std::memory_order_relaxed);
+				}
+
+				frameEnd += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+					std::chrono::duration<float, std::chrono::milliseconds::period>(timerInterval));
+				lock.lock();
+				startupWake.wait_until(lock, frameEnd, [&] { return uiReady; });
+			}
+		});
+	}
+	auto stopStartupRun = [&]() {
+		{
+			std::lock_guard<std::mutex> lock(startupMutex);
+			uiReady = true;
+		}
+		startupWake.notify_all();
+		if (startupRun.joinable()) {
+			startupRun.join();
+		}
+	};
+
 	// Create a larger window to accommodate the organized debugger UI
 	if (!graphics.Init(1200, 800)) {
 		std::cout << "Failed to initialize debugger." << std::endl;
+		stopStartupRun();
 		return -1;
 	}
 
+	// Sound is optional; without an audio device we just run silently
+	Audio audio;
+	audio.Init();
+
+	graphics.SetDisplayScale(scale);
+	if (!paletteText.empty()) {
+		std::string paletteError;
+		if (!graphics.SetPalette(paletteText, paletteError)) {
+			std::cout << paletteError << " (using the default colours)" << std::endl;
+		}
+	}
+
+	if (!keyMapPath.empty()) {
+		std::string keyMapError;
+		if (!graphics.LoadKeyMap(keyMapPath, keyMapError)) {
+			std::cout << keyMapError << " (using the default keys)" << std::endl;
+		}
+	}
+
+	if (!metricsPath.empty()) {
+		MetricsFormat format = MetricsFormat::Prometheus;
+		size_t dot = metricsPath.rfind('.');
+		if (dot != std::string::npos && (metricsPath.substr(dot) == ".json" || metricsPath.substr(dot) == ".jsonl")) {
+			format = MetricsFormat::JsonLines;
+		}
+		std::string metricsError;
+		if (!metricsExporter.Start(metrics, format, metricsPath, metricsInterval, metricsError)) {
+			std::cout << metricsError << std::endl;
+		}
+	}
+
+	if (!gdbAddress.empty()) {
+		std::string gdbError;
+		if (gdb.Start(gdbAddress, false, gdbError)) {
+			std::cout << "GDB stub listening on " << gdbAddress << std::endl;
+		} else {
+			std::cout << gdbError << std::endl;
+		}
+	}
+
 	// Set up ROM directory for the selector (assuming executable is in build/ directory)
 	graphics.SetRomsDirectory("../roms");
 
-	// Load ROM if one was specified
-	if (romLoaded) {
-		chip8.LoadROM(romPath.c_str());
-		graphics.SetRomPath(romPath);
-	}
+	// The main loop has the machine from here on
+	stopStartupRun();
 
 	// ROM selector is now integrated into the Controls window and will be visible automatically
 	auto lastCycleTime = std::chrono::high_resolution_clock::now();
-	auto lastTimerTime = std::chrono::high_resolution_clock::now();
-	
-	// Timer runs at 60Hz = 16.67ms per timer tick
-	const float timerInterval = 1000.0f / 60.0f; // ~16.67ms
+	auto lastTimerTime = lastCycleTime;
 	
 	bool quit = false;
 	SDL_Event event;
 
+	// Keypad changes from the keyboard and the Keyboard window, applied to the machine by the CPU section
+	KeyEventQueue& keyEvents = graphics.GetKeyEvents();
+	auto applyKey = [&](const KeyEventQueue::Event& key) {
+		chip8.SetKey(key.key, key.pressed);
+		recording.Key(key.key, key.pressed);
+		graphics.KeyApplied(key, chip8);
+	};
+
 	while (!quit)
 	{
+		TraceZone loopZone("Main loop");
 		auto currentTime = std::chrono::high_resolution_clock::now();
 
-		// Handle SDL events
-		while (SDL_PollEvent(&event))
+		// Key changes stamped up to here can be applied this iteration (everything, unless the CPU runs a batch)
+		auto keysDueBy = KeyEventQueue::Clock::time_point::max();
+
+		// Handle SDL events. Key changes are queued with their timestamps and applied in the CPU section below.
 		{
-			// Let ImGui process the event first <- UI stuff
-			graphics.ProcessEvent(&event);
-			
-			// Handle CHIP-8 keyboard input and check for quit
-			if (!graphics.HandleInput(&event, chip8)) {
-				quit = true;
+			TraceZone zone("SDL_PollEvent");
+			while (SDL_PollEvent(&event))
+			{
+				// Let ImGui process the event first <- UI stuff
+				graphics.ProcessEvent(&event);
+				
+				// Handle CHIP-8 keyboard input and check for quit
+				if (!graphics.HandleInput(&event, chip8)) {
+					quit = true;
+				}
 			}
 		}
 		
 		// Check for ROM load request
 		if (graphics.IsRomLoadRequested()) {
+			TraceZone zone("Load ROM");
+
 			// Load the selected ROM
 			std::string newRomPath = graphics.GetSelectedRomPath();
 
-			// Only load if a valid path is provided
+			// Only load if a valid path is provided; on failure keep running the current ROM
+			std::shared_ptr<const RomImage> newRom;
 			if (!newRomPath.empty()) {
-				chip8 = Chip8(); // Reset the system
-				chip8.LoadROM(newRomPath.c_str());
+				newRom = romCache.Get(newRomPath, romError);
+				if (!newRom) {
+					std::cout << romError << std::endl;
+				}
+			}
+
+			if (newRom) {
+				currentRom = newRom;
+				chip8.Reset();
+				chip8.LoadROM(*currentRom);
 				graphics.SetRomPath(newRomPath);
+				graphics.AnalyseProgram(chip8);
+				romWatcher.Watch(newRomPath);
+				startRun();
 				romPath = newRomPath;
 				romLoaded = true;
-				std::cout << "Loaded ROM: " << newRomPath << std::endl;
+				std::cout << "Loaded ROM: " << newRomPath << " (" << VariantName(chip8.variant) << ", "
+					<< currentRom->data.size() << " bytes, hash " << std::hex << currentRom->hash << std::dec << ")" << std::endl;
 			}
 			graphics.RomLoadHandled();
 		}
@@ -101,57 +348,235 @@ int main(int argc, char* argv[])
 		// Check for reset request
 		if (graphics.ShouldReset()) {
 
-			// Reset the CHIP-8 system
-			chip8 = Chip8();
+			// Reset the CHIP-8 system, keeping the variant picked for this ROM
+			Variant variant = chip8.variant;
+			chip8.Reset();
 
-			// Reload the current ROM if one is loaded
-			if (romLoaded && !romPath.empty()) {
-				chip8.LoadROM(romPath.c_str());
+			// Reload the current ROM if one is loaded (from memory, no disk access)
+			if (romLoaded && currentRom) {
+				chip8.LoadROM(*currentRom);
 			}
+			chip8.variant = variant;
+			startRun();
 
 			graphics.ResetHandled();
 			continue; // Skip this frame to let reset complete
 		}
 		
+		// Hot reload: the watcher thread flags changes, so this is just an atomic read
+		if (romLoaded && romWatcher.ConsumeChange() && graphics.GetHotReloadMode() != Graphics::HotReload::Off) {
+			TraceZone zone("Hot reload");
+			romCache.Evict(romPath);
+			std::shared_ptr<const RomImage> newRom = romCache.Get(romPath, romError);
+
+			// A half-written or broken build: keep running the old one until the next change
+			if (!newRom) {
+				std::cout << "Hot reload failed: " << romError << std::endl;
+			} else {
+				Variant variant = chip8.variant;
+
+				switch (graphics.GetHotReloadMode()) {
+					case Graphics::HotReload::KeepState:
+						// Swap the new code in under the running machine, clearing whatever the old build left past its end
+						if (newRom->data.size() < currentRom->data.size()) {
+							for (size_t i = newRom->data.size(); i < currentRom->data.size(); ++i) {
+								chip8.Write(static_cast<uint16_t>(PC_START_ADDRESS + i), 0);
+							}
+						}
+						chip8.LoadROM(*newRom);
+						break;
+
+					case Graphics::HotReload::Replay:
+						chip8.Reset();
+						chip8.LoadROM(*newRom);
+						chip8.variant = variant;
+						recording.Replay(chip8);
+						std::cout << "Replayed " << recording.Frames() << " frames of input" << std::endl;
+						break;
+
+					default:
+						chip8.Reset();
+						chip8.LoadROM(*newRom);
+						startRun();
+						break;
+				}
+				chip8.variant = variant;
+				currentRom = newRom;
+				graphics.AnalyseProgram(chip8);
+				std::cout << "Reloaded ROM: " << romPath << std::endl;
+			}
+		}
+
+		// Answer GDB between batches, with or without a ROM (it then sees the empty machine);
+		// it can hold the CPU like Pause does
+		Debugger& debugger = graphics.GetDebugger();
+		bool vipTiming = graphics.UseVipTiming();
+		gdb.Service(chip8, debugger, vipTiming);
+
 		// Handle CPU cycles (only if ROM is loaded)
 		if (romLoaded) {
-			if (graphics.IsStepMode()) {
-				chip8.Cycle();
+			TraceZone zone("Chip8::Run");
+
+			if (gdb.IsStopped()) {
+				// A step GDB made with VIP timing isn't time to make up afterwards
+				lastCycleTime = currentTime;
+				if (vipTiming) {
+					vipCycleTarget = std::max(vipCycleTarget, chip8.machineCycles);
+				}
+			}
+
+			else if (graphics.IsStepMode()) {
+				// Step always executes one instruction, even on a breakpoint, in an idle loop or
+				// in a display wait (the frame it waits for counts as drawn, as on the VIP path)
+				while (!keyEvents.Empty()) {
+					applyKey(keyEvents.Pop());
+				}
+				chip8.idle = false;
+				chip8.waitingForVBlank = false;
+				uint64_t cyclesBefore = chip8.machineCycles;
+				if (vipTiming) {
+					countRun(chip8.RunTimed<false>(cyclesBefore + 1), cyclesBefore);
+					vipCycleTarget = std::max(vipCycleTarget, chip8.machineCycles);
+				} else {
+					countRun(chip8.Run<false>(1), cyclesBefore);
+				}
 				graphics.StepHandled();
 			} 
 			
 			else if (!graphics.IsPaused()) {
 				float cpuDt = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastCycleTime).count();
-				if (cpuDt > cycleDelay) {
-					chip8.Cycle();
-					lastCycleTime = currentTime;
+				float delay = chip8.hires ? cycleDelay / hiresSpeedup : cycleDelay;
+				int maxCycles = maxCyclesPerIteration;
+				auto batchStart = lastCycleTime;
+
+				// Run every instruction that's due since the last iteration in one batch.
+				// With VIP timing the batch is whole frames' budgets of machine cycles instead.
+				int cycles = static_cast<int>(cpuDt / delay);
+				if (vipTiming) {
+					delay = timerInterval / VIP_CYCLES_PER_FRAME;
+					cycles = static_cast<int>(cpuDt / timerInterval) * VIP_CYCLES_PER_FRAME;
+					maxCycles = maxFramesPerIteration * VIP_CYCLES_PER_FRAME;
+				}
+				uint64_t batchCycle = vipCycleTarget;
+				if (cycles > 0) {
+					if (cycles > maxCycles) {
+						cycles = maxCycles;
+						lastCycleTime = currentTime;
+					} else {
+						lastCycleTime += std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+							std::chrono::duration<float, std::chrono::milliseconds::period>(cycles * delay));
+					}
+
+					// Split the batch at each queued key change, so it lands on the instruction it happened during
+					int done = 0;
+					while (done < cycles) {
+						int until = cycles;
+						if (!keyEvents.Empty()) {
+							int at = KeyEventQueue::InstructionAt(keyEvents.Front().time, batchStart, delay, cycles);
+							if (at <= done) {
+								applyKey(keyEvents.Pop());
+								continue;
+							}
+							until = at;
+						}
+
+						// Only take the debug path when something is set
+						int ran;
+						bool hit = false;
+						uint64_t cyclesBefore = chip8.machineCycles;
+						if (vipTiming) {
+							vipCycleTarget = batchCycle + until;
+							ran = debugger.IsActive() ? chip8.RunTimed<true>(vipCycleTarget, &debugger) : chip8.RunTimed<false>(vipCycleTarget);
+							hit = debugger.IsActive() && debugger.ConsumeHit();
+						} else if (debugger.IsActive()) {
+							ran = chip8.Run<true>(until - done, &debugger);
+							hit = debugger.ConsumeHit();
+						} else {
+							ran = chip8.Run<false>(until - done);
+						}
+						countRun(ran, cyclesBefore);
+
+						if (hit) {
+							// Time stops at the breakpoint rather than being made up after it
+							if (vipTiming) {
+								vipCycleTarget = chip8.machineCycles;
+							}
+
+							// An attached GDB owns the stop; otherwise pause and show it in the UI
+							if (gdb.IsAttached()) {
+								gdb.ReportBreak();
+							} else {
+								graphics.OnBreak();
+							}
+							break;
+						}
+
+						// Stopping short (idle loop, display wait) just means that stretch of time had nothing to run
+						done = until;
+					}
 				}
+				keysDueBy = lastCycleTime;
 			}
 		}
+
+		// Key changes the CPU didn't reach are applied now; while running, later ones wait for the batch that covers them
+		while (!keyEvents.Empty() && keyEvents.Front().time <= keysDueBy) {
+			applyKey(keyEvents.Pop());
+		}
 		
 		// Handle timers at 60Hz (independent of CPU speed)
 		float timerDt = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastTimerTime).count();
 		if (timerDt >= timerInterval)
 		{
+			TraceZone zone("Timers");
 			lastTimerTime = currentTime;
 			
-			// Decrement timers at 60Hz
-			if (chip8.delayTimer > 0) 
-			{
-				chip8.delayTimer--;
+			// Decrement timers at 60Hz (with VIP timing the machine's own interrupt does)
+			if (!graphics.UseVipTiming()) {
+				chip8.TickTimers();
+				recording.Tick();
 			}
-			if (chip8.soundTimer > 0) 
-			{
-				chip8.soundTimer--;
-				// TODO: Implement beeping sound when soundTimer > 0
+
+			// Emulated timer time against wall-clock time since startup; ticks only ever run late
+			Metrics::Add(metrics.framesEmulated, 1);
+			double timerElapsed = std::chrono::duration<double, std::micro>(currentTime - timerStart).count();
+			metrics.timerDriftMicros.store(static_cast<int64_t>(metrics.framesEmulated.load(std::memory_order_relaxed) * timerInterval * 1000.0 - timerElapsed), std::memory_order_relaxed);
+			metrics.audioQueued.store(static_cast<uint32_t>(audio.QueuedTicks()), std::memory_order_relaxed);
+			metrics.captureQueued.store(static_cast<uint32_t>(graphics.GetCapture().Queued()), std::memory_order_relaxed);
+			metrics.framesDropped.store(graphics.GetCapture().Dropped(), std::memory_order_relaxed);
+
+			// Queue this tick's beep and frame. Nothing is queued while paused, so the output fades to silence.
+			if (romLoaded && !graphics.IsPaused() && !gdb.IsStopped()) {
+				audio.Produce(chip8);
+				graphics.GetCapture().Submit(chip8);
 			}
 		}
 		
 		// Render everything in one call
 		graphics.RenderFrame(chip8);
+
+		if (metrics.firstPresentMicros.load(std::memory_order_relaxed) == 0) {
+			metrics.firstPresentMicros.store(sinceStartup(), std::memory_order_relaxed);
+			std::cout << "Start-up: ";
+			if (romLoaded) {
+				std::cout << "first frame emulated after " << metrics.firstFrameMicros.load(std::memory_order_relaxed) / 1000.0 << "ms, ";
+			}
+			std::cout << "on screen after " << metrics.firstPresentMicros.load(std::memory_order_relaxed) / 1000.0 << "ms" << std::endl;
+		}
 	}
 
 	// Clean up
+	if (!tracePath.empty()) {
+		std::string traceError;
+		if (Trace::Export(tracePath, traceError)) {
+			std::cout << "Saved trace to " << tracePath << std::endl;
+		} else {
+			std::cout << traceError << std::endl;
+		}
+	}
+	metricsExporter.Stop();
+	gdb.Stop();
+	audio.Shutdown();
 	graphics.Shutdown();
 
 	return 0;
@@ -0,0 +1,247 @@
+#include "metrics.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+void Metrics::RecordFrameTime(std::chrono::high_resolution_clock::duration duration)
+{
+	uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	double ms = micros / 1000.0;
+
+	unsigned int bucket = 0;
+	while (bucket < FRAME_TIME_BUCKET_COUNT - 1 && ms > FRAME_TIME_BUCKETS_MS[bucket]) bucket++;
+
+	Add(frameTimeBuckets[bucket], 1);
+	Add(frameTimeMicros, micros);
+}
+
+MetricsSnapshot Snapshot(const Metrics& metrics)
+{
+	MetricsSnapshot s;
+	s.time = std::chrono::steady_clock::now();
+	s.instructions = metrics.instructions.load(std::memory_order_relaxed);
+	s.framesEmulated = metrics.framesEmulated.load(std::memory_order_relaxed);
+	s.framesPresented = metrics.framesPresented.load(std::memory_order_relaxed);
+	s.textureUploads = metrics.textureUploads.load(std::memory_order_relaxed);
+	s.uiRenderMicros = metrics.uiRenderMicros.load(std::memory_order_relaxed);
+	for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT; ++i)
+	{
+		s.frameTimeBuckets[i] = metrics.frameTimeBuckets[i].load(std::memory_order_relaxed);
+	}
+	s.frameTimeMicros = metrics.frameTimeMicros.load(std::memory_order_relaxed);
+	s.keyEvents = metrics.keyEvents.load(std::memory_order_relaxed);
+	s.inputLatencyMicros = metrics.inputLatencyMicros.load(std::memory_order_relaxed);
+	s.inputLatencySamples = metrics.inputLatencySamples.load(std::memory_order_relaxed);
+	s.framesDropped = metrics.framesDropped.load(std::memory_order_relaxed);
+	s.timerDriftMicros = metrics.timerDriftMicros.load(std::memory_order_relaxed);
+	s.audioQueued = metrics.audioQueued.load(std::memory_order_relaxed);
+	s.captureQueued = metrics.captureQueued.load(std::memory_order_relaxed);
+	s.lastInputLatencyMicros = metrics.lastInputLatencyMicros.load(std::memory_order_relaxed);
+	s.firstFrameMicros = metrics.firstFrameMicros.load(std::memory_order_relaxed);
+	s.firstPresentMicros = metrics.firstPresentMicros.load(std::memory_order_relaxed);
+	return s;
+}
+
+static double Rate(uint64_t now, uint64_t earlier, const MetricsSnapshot& a, const MetricsSnapshot& b)
+{
+	double seconds = std::chrono::duration<double>(a.time - b.time).count();
+	return seconds > 0 ? (now - earlier) / seconds : 0;
+}
+
+double MetricsSnapshot::InstructionsPerSecond(const MetricsSnapshot& earlier) const
+{
+	return Rate(instructions, earlier.instructions, *this, earlier);
+}
+
+double MetricsSnapshot::EmulatedFps(const MetricsSnapshot& earlier) const
+{
+	return Rate(framesEmulated, earlier.framesEmulated, *this, earlier);
+}
+
+double MetricsSnapshot::PresentedFps(const MetricsSnapshot& earlier) const
+{
+	return Rate(framesPresented, earlier.framesPresented, *this, earlier);
+}
+
+double MetricsSnapshot::UploadsPerSecond(const MetricsSnapshot& earlier) const
+{
+	return Rate(textureUploads, earlier.textureUploads, *this, earlier);
+}
+
+double MetricsSnapshot::UiRenderMillis(const MetricsSnapshot& earlier) const
+{
+	uint64_t frames = framesPresented - earlier.framesPresented;
+	return frames ? (uiRenderMicros - earlier.uiRenderMicros) / 1000.0 / frames : 0;
+}
+
+double MetricsSnapshot::InputLatencyMillis(const MetricsSnapshot& earlier) const
+{
+	uint64_t samples = inputLatencySamples - earlier.inputLatencySamples;
+	return samples ? (inputLatencyMicros - earlier.inputLatencyMicros) / 1000.0 / samples : 0;
+}
+
+uint64_t MetricsSnapshot::FrameCount() const
+{
+	uint64_t count = 0;
+	for (uint64_t bucket : frameTimeBuckets) count += bucket;
+	return count;
+}
+
+std::string MetricsExporter::FormatPrometheus(const MetricsSnapshot& now, const MetricsSnapshot& earlier)
+{
+	std::ostringstream out;
+	auto metric = [&](const char* name, const char* type, const char* help, double value)
+	{
+		out << "# HELP " << name << " " << help << "\n";
+		out << "# TYPE " << name << " " << type << "\n";
+		out << name << " " << value << "\n";
+	};
+
+	out.precision(12);
+	metric("chip8_instructions_total", "counter", "Instructions executed.", now.instructions);
+	metric("chip8_instructions_per_second", "gauge", "Instructions per second over the last interval.", now.InstructionsPerSecond(earlier));
+	metric("chip8_frames_emulated_total", "counter", "60Hz timer ticks emulated.", now.framesEmulated);
+	metric("chip8_frames_presented_total", "counter", "Frames drawn to the window.", now.framesPresented);
+	metric("chip8_frames_dropped_total", "counter", "Capture frames dropped because the encoder fell behind.", now.framesDropped);
+	metric("chip8_texture_uploads_total", "counter", "Display texture uploads.", now.textureUploads);
+	metric("chip8_ui_render_seconds_total", "counter", "Time spent building and drawing the UI.", now.uiRenderMicros / 1e6);
+	metric("chip8_timer_drift_seconds", "gauge", "Emulated timer time minus wall-clock time.", now.timerDriftMicros / 1e6);
+	metric("chip8_audio_queue_ticks", "gauge", "Sound timer ticks queued for the audio callback.", now.audioQueued);
+	metric("chip8_capture_queue_frames", "gauge", "Frames queued for the capture encoder.", now.captureQueued);
+	metric("chip8_key_events_total", "counter", "Keypad changes applied.", now.keyEvents);
+	metric("chip8_startup_first_frame_seconds", "gauge", "Start-up to the first emulated frame of the program.", now.firstFrameMicros / 1e6);
+	metric("chip8_startup_first_present_seconds", "gauge", "Start-up to the first frame on screen.", now.firstPresentMicros / 1e6);
+
+	out << "# HELP chip8_input_latency_seconds Key press to the first presented frame it changed.\n";
+	out << "# TYPE chip8_input_latency_seconds summary\n";
+	out << "chip8_input_latency_seconds_sum " << now.inputLatencyMicros / 1e6 << "\n";
+	out << "chip8_input_latency_seconds_count " << now.inputLatencySamples << "\n";
+
+	// Histogram buckets are cumulative
+	out << "# HELP chip8_frame_time_seconds Host time per frame.\n";
+	out << "# TYPE chip8_frame_time_seconds histogram\n";
+	uint64_t cumulative = 0;
+	for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT; ++i)
+	{
+		cumulative += now.frameTimeBuckets[i];
+		out << "chip8_frame_time_seconds_bucket{le=\"";
+		if (i < FRAME_TIME_BUCKET_COUNT - 1) out << FRAME_TIME_BUCKETS_MS[i] / 1000.0;
+		else out << "+Inf";
+		out << "\"} " << cumulative << "\n";
+	}
+	out << "chip8_frame_time_seconds_sum " << now.frameTimeMicros / 1e6 << "\n";
+	out << "chip8_frame_time_seconds_count " << cumulative << "\n";
+	return out.str();
+}
+
+std::string MetricsExporter::FormatJson(const MetricsSnapshot& now, const MetricsSnapshot& earlier)
+{
+	std::ostringstream out;
+	out.precision(12);
+	out << "{\"time\":" << std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count()
+		<< ",\"instructions\":" << now.instructions
+		<< ",\"ips\":" << now.InstructionsPerSecond(earlier)
+		<< ",\"frames_emulated\":" << now.framesEmulated
+		<< ",\"frames_presented\":" << now.framesPresented
+		<< ",\"frames_dropped\":" << now.framesDropped
+		<< ",\"emulated_fps\":" << now.EmulatedFps(earlier)
+		<< ",\"presented_fps\":" << now.PresentedFps(earlier)
+		<< ",\"texture_uploads\":" << now.textureUploads
+		<< ",\"ui_render_ms\":" << now.UiRenderMillis(earlier)
+		<< ",\"timer_drift_ms\":" << now.timerDriftMicros / 1000.0
+		<< ",\"audio_queue\":" << now.audioQueued
+		<< ",\"capture_queue\":" << now.captureQueued
+		<< ",\"key_events\":" << now.keyEvents
+		<< ",\"input_latency_ms\":" << now.InputLatencyMillis(earlier)
+		<< ",\"first_frame_ms\":" << now.firstFrameMicros / 1000.0
+		<< ",\"first_present_ms\":" << now.firstPresentMicros / 1000.0
+		<< ",\"frame_time_buckets_ms\":[";
+	for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT - 1; ++i)
+	{
+		out << (i ? "," : "") << FRAME_TIME_BUCKETS_MS[i];
+	}
+	out << "],\"frame_time_counts\":[";
+	for (unsigned int i = 0; i < FRAME_TIME_BUCKET_COUNT; ++i)
+	{
+		out << (i ? "," : "") << now.frameTimeBuckets[i] - earlier.frameTimeBuckets[i];
+	}
+	out << "]}";
+	return out.str();
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	Stop();
+}
+
+bool MetricsExporter::Start(const Metrics& source, MetricsFormat exportFormat, const std::string& file, unsigned int intervalMs, std::string& error)
+{
+	Stop();
+
+	// Check the file can be written now rather than failing quietly every interval
+	std::ofstream test(file, std::ios::app);
+	if (!test)
+	{
+		error = "Failed to open metrics file: " + file;
+		return false;
+	}
+
+	metrics = &source;
+	format = exportFormat;
+	path = file;
+	interval = std::chrono::milliseconds(intervalMs ? intervalMs : 1000);
+	stopping = false;
+	thread = std::thread(&MetricsExporter::Worker, this);
+	return true;
+}
+
+void MetricsExporter::Stop()
+{
+	if (!thread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	thread.join();
+}
+
+void MetricsExporter::Worker()
+{
+	MetricsSnapshot earlier = Snapshot(*metrics);
+	bool done = false;
+	while (!done)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			done = wake.wait_for(lock, interval, [this] { return stopping; });
+		}
+
+		MetricsSnapshot now = Snapshot(*metrics);
+		if (!Write(now, earlier))
+		{
+			std::fprintf(stderr, "Failed to write metrics to %s\n", path.c_str());
+		}
+		earlier = now;
+	}
+}
+
+bool MetricsExporter::Write(const MetricsSnapshot& now, const MetricsSnapshot& earlier)
+{
+	if (format == MetricsFormat::JsonLines)
+	{
+		std::ofstream file(path, std::ios::app);
+		file << FormatJson(now, earlier) << "\n";
+		return static_cast<bool>(file);
+	}
+
+	// Scrapers must never see a half-written file
+	std::string temp = path + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::trunc);
+		file << FormatPrometheus(now, earlier);
+		if (!file) return false;
+	}
+	return std::rename(temp.c_str(), path.c_str()) == 0;
+}
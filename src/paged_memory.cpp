@@ -0,0 +1,124 @@
+#include "paged_memory.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	// The header gets a cache line to itself, so reference counting never
+	// contends with reads of the bytes
+	struct PageBlock
+	{
+		alignas(64) std::atomic<uint32_t> refs;
+		alignas(64) uint8_t bytes[MEMORY_PAGE_SIZE];
+	};
+}
+
+// Never freed, never written: its count only has to stay away from 1
+static const uint32_t ZERO_PAGE_REFS = 1u << 30;
+
+uint8_t* PagedMemory::ZeroPage()
+{
+	static_assert(offsetof(PageBlock, bytes) == HEADER_SIZE, "PagedMemory::HEADER_SIZE must match the page layout");
+	static PageBlock zero = { { ZERO_PAGE_REFS }, {} };
+	return zero.bytes;
+}
+
+uint8_t* PagedMemory::NewPage(const uint8_t* contents)
+{
+	PageBlock* page = new PageBlock;
+	page->refs.store(1, std::memory_order_relaxed);
+	std::memcpy(page->bytes, contents, MEMORY_PAGE_SIZE);
+	return page->bytes;
+}
+
+void PagedMemory::Retain(uint8_t* bytes)
+{
+	if (bytes == ZeroPage()) return;
+	Refs(bytes).fetch_add(1, std::memory_order_relaxed);
+}
+
+void PagedMemory::Release(uint8_t* bytes)
+{
+	if (bytes == ZeroPage()) return;
+	if (Refs(bytes).fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		delete reinterpret_cast<PageBlock*>(bytes - HEADER_SIZE);
+	}
+}
+
+PagedMemory::PagedMemory()
+{
+	uint8_t* zero = ZeroPage();
+	for (uint8_t*& page : pages) page = zero;
+}
+
+PagedMemory::PagedMemory(const PagedMemory& other)
+{
+	std::memcpy(pages, other.pages, sizeof(pages));
+	for (uint8_t* page : pages) Retain(page);
+}
+
+PagedMemory& PagedMemory::operator=(const PagedMemory& other)
+{
+	if (this == &other) return *this;
+	for (unsigned int i = 0; i < MEMORY_PAGE_COUNT; ++i)
+	{
+		if (pages[i] == other.pages[i]) continue;
+		Retain(other.pages[i]);
+		Release(pages[i]);
+		pages[i] = other.pages[i];
+	}
+	return *this;
+}
+
+PagedMemory::~PagedMemory()
+{
+	for (uint8_t* page : pages) Release(page);
+}
+
+void PagedMemory::Unshare(unsigned int page)
+{
+	uint8_t* copy = NewPage(pages[page]);
+	Release(pages[page]);
+	pages[page] = copy;
+}
+
+void PagedMemory::Copy(uint32_t start, uint8_t* out, size_t count) const
+{
+	while (count > 0)
+	{
+		uint32_t offset = start % MEMORY_PAGE_SIZE;
+		size_t chunk = std::min<size_t>(count, MEMORY_PAGE_SIZE - offset);
+		std::memcpy(out, pages[(start / MEMORY_PAGE_SIZE) % MEMORY_PAGE_COUNT] + offset, chunk);
+		out += chunk;
+		start += static_cast<uint32_t>(chunk);
+		count -= chunk;
+	}
+}
+
+bool PagedMemory::Share(const PagedMemory& source, unsigned int first, unsigned int count)
+{
+	bool all = true;
+	for (unsigned int i = first; i < first + count && i < MEMORY_PAGE_COUNT; ++i)
+	{
+		if (pages[i] == source.pages[i]) continue;
+		if (!IsZeroPage(i))
+		{
+			all = false;
+			continue;
+		}
+		Retain(source.pages[i]);
+		pages[i] = source.pages[i];
+	}
+	return all;
+}
+
+unsigned int PagedMemory::PrivatePages() const
+{
+	unsigned int count = 0;
+	for (uint8_t* page : pages)
+	{
+		if (page != ZeroPage() && Refs(page).load(std::memory_order_relaxed) == 1) ++count;
+	}
+	return count;
+}
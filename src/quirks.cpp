@@ -0,0 +1,59 @@
+#include "quirks.h"
+
+const char* VariantName(Variant variant)
+{
+	switch (variant)
+	{
+		case Variant::Chip8:     return "CHIP-8";
+		case Variant::SuperChip: return "SUPER-CHIP";
+		case Variant::XoChip:    return "XO-CHIP";
+	}
+	return "Unknown";
+}
+
+bool ParseVariant(const std::string& name, Variant& variant)
+{
+	if (name == "chip8")  { variant = Variant::Chip8;     return true; }
+	if (name == "schip")  { variant = Variant::SuperChip; return true; }
+	if (name == "xochip") { variant = Variant::XoChip;    return true; }
+	return false;
+}
+
+Variant DetectVariant(const uint8_t* rom, size_t size)
+{
+	// Anything that doesn't fit in 4K can only be XO-CHIP
+	if (size > 0x1000 - 0x200) return Variant::XoChip;
+
+	bool superChip = false;
+
+	// Instructions are normally 2-byte aligned from 0x200, so only look at even offsets.
+	// Sprite data can still look like an opcode; this is a best guess.
+	for (size_t i = 0; i + 1 < size; i += 2)
+	{
+		uint16_t opcode = rom[i] << 8 | rom[i + 1];
+		uint8_t x = (opcode & 0x0F00) >> 8;
+		uint8_t nn = opcode & 0x00FF;
+
+		switch (opcode & 0xF000)
+		{
+			case 0x0000:
+				if ((opcode & 0xFFF0) == 0x00D0 && (opcode & 0xF)) return Variant::XoChip; // scroll up
+				if ((opcode & 0xFFF0) == 0x00C0 && (opcode & 0xF)) superChip = true;      // scroll down
+				if (opcode >= 0x00FB && opcode <= 0x00FF) superChip = true;              // scroll, exit, lores/hires
+				break;
+
+			case 0x5000:
+				if ((opcode & 0xF) == 0x2 || (opcode & 0xF) == 0x3) return Variant::XoChip; // save/load VX..VY
+				break;
+
+			case 0xF000:
+				if (opcode == 0xF000 || opcode == 0xF002) return Variant::XoChip; // long I, audio pattern
+				if (nn == 0x01 && x <= 3) return Variant::XoChip;                 // plane select
+				if (nn == 0x3A) return Variant::XoChip;                           // pitch
+				if (nn == 0x30 || nn == 0x75 || nn == 0x85) superChip = true;     // big font, flags
+				break;
+		}
+	}
+
+	return superChip ? Variant::SuperChip : Variant::Chip8;
+}
@@ -0,0 +1,157 @@
+#include "rom.h"
+#include "const.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint64_t HashRom(const uint8_t* data, size_t size)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+// Map the file and copy it into the image in one go. The mapping isn't kept:
+// the image must not change if the file is rewritten while we're running.
+static bool ReadRomFile(const std::string& path, std::vector<uint8_t>& data, std::string& error)
+{
+#ifndef _WIN32
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		error = "Failed to open ROM: " + path + " (" + std::strerror(errno) + ")";
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+	{
+		error = "Not a regular file: " + path;
+		close(fd);
+		return false;
+	}
+
+	data.resize(static_cast<size_t>(info.st_size));
+	if (!data.empty())
+	{
+		void* mapped = mmap(nullptr, data.size(), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED)
+		{
+			error = "Failed to map ROM: " + path + " (" + std::strerror(errno) + ")";
+			close(fd);
+			return false;
+		}
+		std::memcpy(data.data(), mapped, data.size());
+		munmap(mapped, data.size());
+	}
+	close(fd);
+	return true;
+#else
+	// Single read of the whole file
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		error = "Failed to open ROM: " + path;
+		return false;
+	}
+	data.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0, std::ios::beg);
+	if (!file.read(reinterpret_cast<char*>(data.data()), data.size()))
+	{
+		error = "Failed to read ROM: " + path;
+		return false;
+	}
+	return true;
+#endif
+}
+
+std::shared_ptr<const RomImage> LoadRomImage(const std::string& path, std::string& error)
+{
+	auto rom = std::make_shared<RomImage>();
+	rom->path = path;
+
+	if (!ReadRomFile(path, rom->data, error)) return nullptr;
+
+	// Validate: it has to fit between 0x200 and the end of memory
+	if (rom->data.empty())
+	{
+		error = "ROM is empty: " + path;
+		return nullptr;
+	}
+	if (rom->data.size() > MEMORY_SIZE - PC_START_ADDRESS)
+	{
+		error = "ROM is too large (" + std::to_string(rom->data.size()) + " bytes): " + path;
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < rom->data.size(); ++i)
+	{
+		rom->memory.Write(PC_START_ADDRESS + static_cast<uint32_t>(i), rom->data[i]);
+	}
+	rom->hash = HashRom(rom->data.data(), rom->data.size());
+	rom->variant = DetectVariant(rom->data.data(), rom->data.size());
+	return rom;
+}
+
+std::shared_ptr<const RomImage> RomCache::Get(const std::string& path, std::string& error)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = byPath.find(path);
+		if (it != byPath.end()) return it->second;
+	}
+
+	// Read outside the lock so a slow disk doesn't block other lookups
+	std::shared_ptr<const RomImage> rom = LoadRomImage(path, error);
+	if (!rom) return nullptr;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Same contents under another path: share the existing image
+	auto existing = byHash.find(rom->hash);
+	if (existing != byHash.end() && existing->second->data == rom->data)
+	{
+		rom = existing->second;
+	}
+	else
+	{
+		byHash[rom->hash] = rom;
+	}
+
+	byPath[path] = rom;
+	return rom;
+}
+
+std::shared_ptr<const RomImage> RomCache::FindByHash(uint64_t hash) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = byHash.find(hash);
+	return it != byHash.end() ? it->second : nullptr;
+}
+
+void RomCache::Evict(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = byPath.find(path);
+	if (it == byPath.end()) return;
+
+	// Only drop the hash entry if no other path still refers to it
+	uint64_t hash = it->second->hash;
+	byPath.erase(it);
+	for (const auto& entry : byPath)
+	{
+		if (entry.second->hash == hash) return;
+	}
+	byHash.erase(hash);
+}
@@ -0,0 +1,272 @@
+#include "rom_library.h"
+#include "chip8.h"
+#include "rom.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+// Index file layout (native endianness; it's a local cache, not an interchange format):
+//   "C8IX" u32 version u32 count, then per entry:
+//   u16 name length, name, i64 mtime, u64 size, u64 hash, u8 variant, u8 hires, thumbnail words
+static const char INDEX_MAGIC[4] = { 'C', '8', 'I', 'X' };
+static const uint32_t INDEX_VERSION = 1;
+
+RomLibrary::~RomLibrary()
+{
+	Stop();
+}
+
+void RomLibrary::Stop()
+{
+	cancel.store(true, std::memory_order_relaxed);
+	if (thread.joinable()) thread.join();
+	cancel.store(false, std::memory_order_relaxed);
+}
+
+void RomLibrary::Scan(const std::string& directory)
+{
+	Stop();
+	if (directory.empty()) return;
+
+	scanning.store(true, std::memory_order_release);
+	thread = std::thread(&RomLibrary::Worker, this, directory);
+}
+
+bool RomLibrary::Poll(std::vector<std::shared_ptr<const RomEntry>>& roms)
+{
+	// The UI polls every frame; if the worker is mid-publish just try again next frame
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock() || polledGeneration == publishedGeneration) return false;
+
+	roms = published;
+	polledGeneration = publishedGeneration;
+	return true;
+}
+
+void RomLibrary::Publish(const std::vector<std::shared_ptr<const RomEntry>>& roms)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	published = roms;
+	++publishedGeneration;
+}
+
+std::shared_ptr<RomEntry> RomLibrary::Analyse(const RomImage& rom, const std::string& name, int64_t mtime)
+{
+	auto entry = std::make_shared<RomEntry>();
+	entry->name = name;
+	entry->mtime = mtime;
+	entry->size = rom.data.size();
+	entry->hash = rom.hash;
+	entry->variant = rom.variant;
+
+	// Run it headless for a couple of seconds and keep whatever it drew
+	Chip8 chip8;
+	chip8.LoadROM(rom);
+	for (unsigned int frame = 0; frame < THUMBNAIL_FRAMES && !chip8.halted; ++frame)
+	{
+		chip8.Run<false>(chip8.hires ? THUMBNAIL_CYCLES_PER_FRAME * 4 : THUMBNAIL_CYCLES_PER_FRAME);
+		chip8.TickTimers();
+	}
+
+	entry->thumbnailHires = chip8.hires;
+	for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+	{
+		for (unsigned int y = 0; y < DISPLAY_HEIGHT; ++y)
+		{
+			for (unsigned int w = 0; w < DISPLAY_ROW_WORDS; ++w)
+			{
+				entry->thumbnail[y][w] |= chip8.display[plane][y][w];
+			}
+		}
+	}
+	return entry;
+}
+
+void RomLibrary::Worker(std::string directory)
+{
+	Trace::NameThread("ROM scan");
+	TraceZone scanZone("RomLibrary::Scan");
+	std::string indexPath = directory + "/" + INDEX_FILE;
+	progress.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+
+	// Previous results, by name and by content
+	std::unordered_map<std::string, std::shared_ptr<const RomEntry>> byName;
+	std::unordered_map<uint64_t, std::shared_ptr<const RomEntry>> byHash;
+	for (const auto& entry : LoadIndex(indexPath))
+	{
+		byName[entry->name] = entry;
+		byHash[entry->hash] = entry;
+	}
+
+	// List the directory first (cheap: no file contents are read)
+	struct Found { std::string name; int64_t mtime; uint64_t size; };
+	std::vector<Found> found;
+	try {
+		for (const auto& file : fs::directory_iterator(directory))
+		{
+			if (cancel.load(std::memory_order_relaxed)) break;
+			if (!file.is_regular_file()) continue;
+
+			// Skip hidden files (including our index) and system files
+			std::string name = file.path().filename().string();
+			if (name[0] == '.' || name == "DS_Store") continue;
+
+			found.push_back({ name, static_cast<int64_t>(file.last_write_time().time_since_epoch().count()), static_cast<uint64_t>(file.file_size()) });
+		}
+	} catch (const fs::filesystem_error& ex) {
+		std::cout << "Error scanning ROMs directory: " << ex.what() << std::endl;
+	}
+	std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.name < b.name; });
+	total.store(static_cast<unsigned int>(found.size()), std::memory_order_relaxed);
+
+	// Show known files straight away, then fill in the rest as they're analysed
+	std::vector<std::shared_ptr<const RomEntry>> roms;
+	std::vector<size_t> changed;
+	for (const Found& f : found)
+	{
+		auto it = byName.find(f.name);
+		if (it != byName.end() && it->second->mtime == f.mtime && it->second->size == f.size)
+		{
+			roms.push_back(it->second);
+		}
+		else
+		{
+			changed.push_back(roms.size());
+			auto placeholder = std::make_shared<RomEntry>();
+			placeholder->name = f.name;
+			placeholder->size = f.size;
+			roms.push_back(placeholder);
+		}
+	}
+	progress.store(static_cast<unsigned int>(roms.size() - changed.size()), std::memory_order_relaxed);
+	Publish(roms);
+
+	auto lastPublish = std::chrono::steady_clock::now();
+	for (size_t i : changed)
+	{
+		if (cancel.load(std::memory_order_relaxed)) break;
+
+		TraceZone zone("RomLibrary::Analyse");
+		const Found& f = found[i];
+		std::string path = directory + "/" + f.name;
+		std::string error;
+		std::shared_ptr<const RomImage> rom = LoadRomImage(path, error);
+		if (rom)
+		{
+			// Touched or renamed but same contents: keep the old analysis
+			auto known = byHash.find(rom->hash);
+			if (known != byHash.end() && known->second->size == rom->data.size())
+			{
+				auto entry = std::make_shared<RomEntry>(*known->second);
+				entry->name = f.name;
+				entry->mtime = f.mtime;
+				roms[i] = entry;
+			}
+			else
+			{
+				roms[i] = Analyse(*rom, f.name, f.mtime);
+			}
+		}
+		else
+		{
+			std::cout << error << std::endl;
+		}
+		progress.fetch_add(1, std::memory_order_relaxed);
+
+		// Hand results over in batches so the UI isn't copying the list for every file
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastPublish > std::chrono::milliseconds(100))
+		{
+			Publish(roms);
+			lastPublish = now;
+		}
+	}
+
+	if (!cancel.load(std::memory_order_relaxed))
+	{
+		Publish(roms);
+		if (!changed.empty() || byName.size() != roms.size()) SaveIndex(indexPath, roms);
+	}
+	scanning.store(false, std::memory_order_release);
+}
+
+std::vector<std::shared_ptr<const RomEntry>> RomLibrary::LoadIndex(const std::string& path)
+{
+	std::vector<std::shared_ptr<const RomEntry>> roms;
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return roms;
+
+	char magic[4];
+	uint32_t version = 0, count = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!file || std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0 || version != INDEX_VERSION) return roms;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto entry = std::make_shared<RomEntry>();
+		uint16_t nameLength = 0;
+		uint8_t variant = 0, hires = 0;
+		file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
+		entry->name.resize(nameLength);
+		file.read(&entry->name[0], nameLength);
+		file.read(reinterpret_cast<char*>(&entry->mtime), sizeof(entry->mtime));
+		file.read(reinterpret_cast<char*>(&entry->size), sizeof(entry->size));
+		file.read(reinterpret_cast<char*>(&entry->hash), sizeof(entry->hash));
+		file.read(reinterpret_cast<char*>(&variant), sizeof(variant));
+		file.read(reinterpret_cast<char*>(&hires), sizeof(hires));
+		file.read(reinterpret_cast<char*>(entry->thumbnail), sizeof(entry->thumbnail));
+
+		// A truncated or corrupt index just means a full rescan
+		if (!file || variant >= VARIANT_COUNT) return {};
+		entry->variant = static_cast<Variant>(variant);
+		entry->thumbnailHires = hires != 0;
+		roms.push_back(entry);
+	}
+	return roms;
+}
+
+void RomLibrary::SaveIndex(const std::string& path, const std::vector<std::shared_ptr<const RomEntry>>& roms)
+{
+	// Write to a temporary file and rename, so a crash never leaves a half-written index
+	std::string temp = path + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file) return; // read-only library: just rescan next time
+
+		uint32_t count = 0;
+		for (const auto& entry : roms) if (entry->hash != 0) ++count;
+
+		file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+		file.write(reinterpret_cast<const char*>(&INDEX_VERSION), sizeof(INDEX_VERSION));
+		file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+		for (const auto& entry : roms)
+		{
+			if (entry->hash == 0) continue; // never analysed (unreadable)
+			uint16_t nameLength = static_cast<uint16_t>(std::min<size_t>(entry->name.size(), 0xFFFF));
+			uint8_t variant = static_cast<uint8_t>(entry->variant);
+			uint8_t hires = entry->thumbnailHires ? 1 : 0;
+			file.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+			file.write(entry->name.data(), nameLength);
+			file.write(reinterpret_cast<const char*>(&entry->mtime), sizeof(entry->mtime));
+			file.write(reinterpret_cast<const char*>(&entry->size), sizeof(entry->size));
+			file.write(reinterpret_cast<const char*>(&entry->hash), sizeof(entry->hash));
+			file.write(reinterpret_cast<const char*>(&variant), sizeof(variant));
+			file.write(reinterpret_cast<const char*>(&hires), sizeof(hires));
+			file.write(reinterpret_cast<const char*>(entry->thumbnail), sizeof(entry->thumbnail));
+		}
+		if (!file) return;
+	}
+
+	std::error_code ec;
+	fs::rename(temp, path, ec);
+}
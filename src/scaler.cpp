@@ -0,0 +1,271 @@
+#include "scaler.h"
+#include <cstring>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCALER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// GCC/Clang build the AVX2 kernel into every x86 binary and pick it at run
+// time; MSVC only has it when the whole build targets AVX2
+#if defined(SCALER_SSE2) && defined(__GNUC__)
+#define SCALER_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(SCALER_SSE2) && defined(__AVX2__)
+#define SCALER_AVX2 1
+#define TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+// One source row: each plane's words
+using Row = uint64_t[DISPLAY_PLANES][DISPLAY_ROW_WORDS];
+
+struct Kernel
+{
+	const char* name;
+	// Source row -> one colour per pixel, `width` (64 or 128) of them. Without
+	// `colour` only plane 0 has pixels, so only palette[0] and [1] are needed.
+	void (*colours)(const Row& row, unsigned int width, bool colour, const uint32_t palette[16], uint32_t* out);
+	// Each of `width` colours repeated `pixel` times
+	void (*widen)(const uint32_t* colours, unsigned int width, unsigned int pixel, uint32_t* out);
+};
+
+// Scalar *********************************************************************
+
+// Only needed off x86; the vector kernels still use WidenScalar for their tails
+#ifndef SCALER_SSE2
+static void ColoursScalar(const Row& row, unsigned int width, bool colour, const uint32_t palette[16], uint32_t* out)
+{
+	unsigned int planes = colour ? DISPLAY_PLANES : 1;
+	for (unsigned int x = 0; x < width; ++x)
+	{
+		unsigned int index = 0;
+		for (unsigned int plane = 0; plane < planes; ++plane)
+		{
+			index |= ((row[plane][x >> 6] >> (63 - (x & 63))) & 1) << plane;
+		}
+		out[x] = palette[index];
+	}
+}
+#endif
+
+static void WidenScalar(const uint32_t* colours, unsigned int width, unsigned int pixel, uint32_t* out)
+{
+	for (unsigned int x = 0; x < width; ++x)
+	{
+		std::fill_n(out + x * pixel, pixel, colours[x]);
+	}
+}
+
+// SSE2, 4 pixels at a time ***************************************************
+
+#ifdef SCALER_SSE2
+// All-ones lanes for the set bits of a nibble, its top bit (the leftmost pixel) in lane 0
+static inline __m128i NibbleMask(uint64_t word, unsigned int x)
+{
+	const __m128i bits = _mm_set_epi32(1, 2, 4, 8);
+	__m128i nibble = _mm_set1_epi32(static_cast<int>((word >> (60 - (x & 63))) & 0xF));
+	return _mm_cmpeq_epi32(_mm_and_si128(nibble, bits), bits);
+}
+
+// `b` where the mask is set, `a` elsewhere
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+
+static void ColoursSse2(const Row& row, unsigned int width, bool colour, const uint32_t palette[16], uint32_t* out)
+{
+	__m128i entries[16];
+	for (unsigned int i = 0; i < 16; ++i) entries[i] = _mm_set1_epi32(static_cast<int>(palette[i]));
+
+	for (unsigned int x = 0; x < width; x += 4)
+	{
+		__m128i* dst = reinterpret_cast<__m128i*>(out + x);
+		__m128i plane0 = NibbleMask(row[0][x >> 6], x);
+		if (!colour)
+		{
+			_mm_storeu_si128(dst, Select(plane0, entries[0], entries[1]));
+			continue;
+		}
+
+		// No shuffle by index in SSE2: pick the colour with a select tree, one plane per level
+		__m128i plane1 = NibbleMask(row[1][x >> 6], x);
+		__m128i plane2 = NibbleMask(row[2][x >> 6], x);
+		__m128i plane3 = NibbleMask(row[3][x >> 6], x);
+		__m128i level[8];
+		for (unsigned int i = 0; i < 8; ++i) level[i] = Select(plane0, entries[2 * i], entries[2 * i + 1]);
+		for (unsigned int i = 0; i < 4; ++i) level[i] = Select(plane1, level[2 * i], level[2 * i + 1]);
+		for (unsigned int i = 0; i < 2; ++i) level[i] = Select(plane2, level[2 * i], level[2 * i + 1]);
+		_mm_storeu_si128(dst, Select(plane3, level[0], level[1]));
+	}
+}
+
+// A pixel is written with whole vectors that may run into the next pixel's
+// span, which that pixel then overwrites. Only the pixels whose vectors would
+// run off the end of the row are written exactly.
+static void WidenSse2(const uint32_t* colours, unsigned int width, unsigned int pixel, uint32_t* out)
+{
+	unsigned int span = (pixel + 3) & ~3u;
+	unsigned int x = 0;
+	for (; x < width && x * pixel + span <= width * pixel; ++x)
+	{
+		__m128i value = _mm_set1_epi32(static_cast<int>(colours[x]));
+		uint32_t* dst = out + x * pixel;
+		for (unsigned int i = 0; i < pixel; i += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+	}
+	WidenScalar(colours + x, width - x, pixel, out + x * pixel);
+}
+#endif
+
+// AVX2, 8 pixels at a time ***************************************************
+
+#ifdef SCALER_AVX2
+TARGET_AVX2 static inline __m256i ByteMask(uint64_t word, unsigned int x)
+{
+	const __m256i bits = _mm256_set_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	__m256i byte = _mm256_set1_epi32(static_cast<int>((word >> (56 - (x & 63))) & 0xFF));
+	return _mm256_cmpeq_epi32(_mm256_and_si256(byte, bits), bits);
+}
+
+TARGET_AVX2 static void ColoursAvx2(const Row& row, unsigned int width, bool colour, const uint32_t palette[16], uint32_t* out)
+{
+	// The palette fits in two registers; planes 0-2 index into both and plane 3 picks one
+	__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(palette));
+	__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(palette + 8));
+	__m256i background = _mm256_set1_epi32(static_cast<int>(palette[0]));
+	__m256i foreground = _mm256_set1_epi32(static_cast<int>(palette[1]));
+
+	for (unsigned int x = 0; x < width; x += 8)
+	{
+		__m256i* dst = reinterpret_cast<__m256i*>(out + x);
+		__m256i plane0 = ByteMask(row[0][x >> 6], x);
+		if (!colour)
+		{
+			_mm256_storeu_si256(dst, _mm256_blendv_epi8(background, foreground, plane0));
+			continue;
+		}
+
+		__m256i index = _mm256_and_si256(plane0, _mm256_set1_epi32(1));
+		index = _mm256_or_si256(index, _mm256_and_si256(ByteMask(row[1][x >> 6], x), _mm256_set1_epi32(2)));
+		index = _mm256_or_si256(index, _mm256_and_si256(ByteMask(row[2][x >> 6], x), _mm256_set1_epi32(4)));
+		__m256i plane3 = ByteMask(row[3][x >> 6], x);
+		__m256i value = _mm256_blendv_epi8(_mm256_permutevar8x32_epi32(low, index), _mm256_permutevar8x32_epi32(high, index), plane3);
+		_mm256_storeu_si256(dst, value);
+	}
+}
+
+TARGET_AVX2 static void WidenAvx2(const uint32_t* colours, unsigned int width, unsigned int pixel, uint32_t* out)
+{
+	unsigned int span = (pixel + 7) & ~7u;
+	unsigned int x = 0;
+	for (; x < width && x * pixel + span <= width * pixel; ++x)
+	{
+		__m256i value = _mm256_set1_epi32(static_cast<int>(colours[x]));
+		uint32_t* dst = out + x * pixel;
+		for (unsigned int i = 0; i < pixel; i += 8) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+	}
+	WidenScalar(colours + x, width - x, pixel, out + x * pixel);
+}
+#endif
+
+// Dispatch *******************************************************************
+
+static const Kernel& SelectKernel()
+{
+	static const Kernel kernel = []
+	{
+#ifdef SCALER_AVX2
+#ifdef __GNUC__
+		if (__builtin_cpu_supports("avx2"))
+#endif
+		{
+			return Kernel{ "AVX2", ColoursAvx2, WidenAvx2 };
+		}
+#endif
+#ifdef SCALER_SSE2
+		return Kernel{ "SSE2", ColoursSse2, WidenSse2 };
+#else
+		return Kernel{ "scalar", ColoursScalar, WidenScalar };
+#endif
+	}();
+	return kernel;
+}
+
+const char* ScalerKernel()
+{
+	return SelectKernel().name;
+}
+
+void ScaleDisplay(const uint64_t display[DISPLAY_PLANES][DISPLAY_HEIGHT][DISPLAY_ROW_WORDS], bool hires, const ScaleOptions& options, uint32_t* out, size_t pitch)
+{
+	const Kernel& kernel = SelectKernel();
+	unsigned int scale = options.scale ? options.scale : 1;
+	unsigned int width = hires ? DISPLAY_WIDTH : LORES_WIDTH;
+	unsigned int height = hires ? DISPLAY_HEIGHT : LORES_HEIGHT;
+	unsigned int pixel = hires ? scale : scale * 2;
+	size_t rowBytes = DISPLAY_WIDTH * scale * sizeof(uint32_t);
+	uint8_t* base = reinterpret_cast<uint8_t*>(out);
+
+	alignas(32) uint32_t colours[DISPLAY_WIDTH];
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		Row row;
+		bool colour = false;
+		for (unsigned int plane = 0; plane < DISPLAY_PLANES; ++plane)
+		{
+			for (unsigned int word = 0; word < DISPLAY_ROW_WORDS; ++word)
+			{
+				row[plane][word] = display[plane][y][word];
+				if (plane) colour |= row[plane][word] != 0;
+			}
+		}
+
+		uint8_t* first = base + static_cast<size_t>(y) * pixel * pitch;
+		if (pixel == 1)
+		{
+			kernel.colours(row, width, colour, options.palette, reinterpret_cast<uint32_t*>(first));
+			continue;
+		}
+		kernel.colours(row, width, colour, options.palette, colours);
+		kernel.widen(colours, width, pixel, reinterpret_cast<uint32_t*>(first));
+		for (unsigned int repeat = 1; repeat < pixel; ++repeat)
+		{
+			std::memcpy(first + repeat * pitch, first, rowBytes);
+		}
+	}
+}
+
+bool ParsePalette(const std::string& text, uint32_t palette[16], std::string& error)
+{
+	uint32_t parsed[16];
+	unsigned int count = 0;
+	std::istringstream list(text);
+	std::string colour;
+	while (std::getline(list, colour, ','))
+	{
+		if (!colour.empty() && colour[0] == '#') colour.erase(0, 1);
+		if (count == 16)
+		{
+			error = "A palette has at most 16 colours";
+			return false;
+		}
+		if (colour.size() != 6 || colour.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+		{
+			error = "Bad palette colour '" + colour + "' (expected RRGGBB)";
+			return false;
+		}
+		uint32_t rgb = static_cast<uint32_t>(std::stoul(colour, nullptr, 16));
+		parsed[count++] = 0xFF000000 | ((rgb & 0xFF) << 16) | (rgb & 0xFF00) | (rgb >> 16);
+	}
+	if (count == 0)
+	{
+		error = "Empty palette";
+		return false;
+	}
+
+	std::copy(parsed, parsed + count, palette);
+	return true;
+}
@@ -0,0 +1,159 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace
+{
+	const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+	// Fields are atomics so the exporter can read a buffer its thread is still writing
+	struct TraceEvent
+	{
+		std::atomic<const char*> name{nullptr};
+		std::atomic<uint64_t> start{0};
+		std::atomic<uint64_t> end{0};
+	};
+
+	// One thread's ring. Single writer; `begun` and `written` bracket each event
+	// like a sequence lock, so the exporter can tell which slots it read whole.
+	struct TraceBuffer
+	{
+		std::unique_ptr<TraceEvent[]> events{new TraceEvent[Trace::EVENTS_PER_THREAD]};
+		std::atomic<uint64_t> begun{0};
+		std::atomic<uint64_t> written{0};
+		std::atomic<const char*> name{nullptr};
+		unsigned int id = 0;
+	};
+
+	// Buffers outlive their threads, so an export still shows threads that have finished
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<TraceBuffer>> registry;
+
+	TraceBuffer& ThisThread()
+	{
+		thread_local TraceBuffer* buffer = nullptr;
+		if (!buffer)
+		{
+			std::lock_guard<std::mutex> lock(registryMutex);
+			registry.emplace_back(new TraceBuffer);
+			buffer = registry.back().get();
+			buffer->id = static_cast<unsigned int>(registry.size());
+		}
+		return *buffer;
+	}
+
+	// Names are our own literals, but keep the output valid whatever they hold
+	void WriteString(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (const char* c = text; *c; ++c)
+		{
+			if (*c == '"' || *c == '\\') out << '\\' << *c;
+			else if (static_cast<unsigned char>(*c) >= 0x20) out << *c;
+		}
+		out << '"';
+	}
+}
+
+uint64_t Trace::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void Trace::Record(const char* name, uint64_t start, uint64_t end)
+{
+	TraceBuffer& buffer = ThisThread();
+	uint64_t index = buffer.written.load(std::memory_order_relaxed);
+	buffer.begun.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	TraceEvent& event = buffer.events[index & (EVENTS_PER_THREAD - 1)];
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.end.store(end, std::memory_order_relaxed);
+	buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::NameThread(const char* name)
+{
+	ThisThread().name.store(name, std::memory_order_relaxed);
+}
+
+uint64_t Trace::Recorded()
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	uint64_t total = 0;
+	for (const auto& buffer : registry) total += buffer->written.load(std::memory_order_relaxed);
+	return total;
+}
+
+std::string Trace::FormatJson()
+{
+	struct Copied
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"chip8\"}}";
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::vector<Copied> events;
+	for (const auto& buffer : registry)
+	{
+		// Copy what's there, then drop the oldest slots if the thread wrapped round onto them meanwhile
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t first = written > EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+		events.clear();
+		for (uint64_t i = first; i < written; ++i)
+		{
+			const TraceEvent& event = buffer->events[i & (EVENTS_PER_THREAD - 1)];
+			events.push_back({ event.name.load(std::memory_order_relaxed), event.start.load(std::memory_order_relaxed), event.end.load(std::memory_order_relaxed) });
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t begun = buffer->begun.load(std::memory_order_relaxed);
+		uint64_t valid = begun > EVENTS_PER_THREAD ? begun - EVENTS_PER_THREAD : 0;
+
+		const char* threadName = buffer->name.load(std::memory_order_relaxed);
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+		if (threadName) WriteString(out, threadName);
+		else out << "\"Thread " << buffer->id << "\"";
+		out << "}}";
+
+		for (uint64_t i = std::max(first, valid); i < written; ++i)
+		{
+			const Copied& event = events[i - first];
+			out << ",\n{\"name\":";
+			WriteString(out, event.name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+				<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+		}
+	}
+	out << "\n]}\n";
+	return out.str();
+}
+
+bool Trace::Export(const std::string& path, std::string& error)
+{
+	std::string json = FormatJson();
+	std::ofstream file(path, std::ios::trunc);
+	file << json;
+	if (!file)
+	{
+		error = "Failed to write trace: " + path;
+		return false;
+	}
+	return true;
+}
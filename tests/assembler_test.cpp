@@ -0,0 +1,60 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assembler.h"
+#include "chip8.h"
+
+// The assembler accepts what Chip8::Disassemble prints, so every instruction
+// word has to survive disassemble -> assemble unchanged. Plus the cases the
+// round trip can't reach: labels, and the F000 NNNN long form.
+
+static bool Assemble(const std::string& source, std::vector<uint8_t>& rom, std::string& error)
+{
+	Assembler assembler;
+	return assembler.Assemble(source, rom, error);
+}
+
+static bool Expect(const char* name, const std::string& source, const std::vector<uint8_t>& expected)
+{
+	std::vector<uint8_t> rom;
+	std::string error;
+	if (!Assemble(source, rom, error)) {
+		std::cout << "FAIL " << name << ": " << error << std::endl;
+		return false;
+	}
+	if (rom != expected) {
+		std::cout << "FAIL " << name << ": got" << std::hex << std::setfill('0');
+		for (uint8_t byte : rom) std::cout << " " << std::setw(2) << (int)byte;
+		std::cout << std::dec << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Every instruction word, one at a time
+	for (unsigned int opcode = 0; opcode <= 0xFFFF; ++opcode) {
+		std::string text = Chip8::Disassemble(static_cast<uint16_t>(opcode));
+		std::vector<uint8_t> rom;
+		std::string error;
+		bool ok = Assemble(text, rom, error);
+		if (!ok || rom.size() != 2 || static_cast<unsigned int>(rom[0] << 8 | rom[1]) != opcode) {
+			std::cout << "FAIL round trip " << std::hex << std::setfill('0') << std::setw(4) << opcode << std::dec
+				<< " \"" << text << "\": " << (ok ? "assembled differently" : error) << std::endl;
+			if (++failures > 20) break;
+		}
+	}
+
+	// Labels that start with LONG are labels, not the long form
+	if (!Expect("LONG-prefixed label", "LD I, LONGjump\nLONGJUMP: CLS\nlongest: JP longest", { 0xA2, 0x02, 0x00, 0xE0, 0x12, 0x04 })) ++failures;
+	if (!Expect("long form with a label", "LD I, LONG longjump\nlongjump: CLS", { 0xF0, 0x00, 0x02, 0x04, 0x00, 0xE0 })) ++failures;
+	if (!Expect("long form with a number", "LD I, LONG 0x1234", { 0xF0, 0x00, 0x12, 0x34 })) ++failures;
+	if (!Expect("long form alone", "LD I, LONG\nDW 0xBEEF", { 0xF0, 0x00, 0xBE, 0xEF })) ++failures;
+
+	std::cout << (failures ? "FAIL" : "PASS") << " assembler round trip" << std::endl;
+	return failures ? 1 : 0;
+}
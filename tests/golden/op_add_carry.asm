@@ -0,0 +1,13 @@
+; 8XY4: with and without carry, and VF as the destination (the flag wins)
+	LD V0, 0xF0
+	LD V1, 0x20
+	ADD V0, V1
+	LD V2, V0
+	LD V3, VF
+	LD V4, 0x10
+	ADD V4, V1
+	LD V5, VF
+	LD VF, 0xFF
+	ADD VF, V1
+end:
+	JP end
@@ -0,0 +1,21 @@
+; 2NNN / 00EE: nested calls, each leaving a mark in its own register.
+; The innermost one stops with the stack still three deep.
+	CALL one
+	LD V4, 0x44
+end:
+	JP end
+
+one:
+	LD V1, 0x11
+	CALL two
+	LD V5, 0x55
+	RET
+
+two:
+	LD V2, 0x22
+	CALL three
+	RET
+
+three:
+	LD V3, 0x33
+	JP end
@@ -0,0 +1,14 @@
+; 00E0: draw two digits, clear, draw one more. Only the last should remain.
+	LD V0, 0
+	LD F, V0
+	LD V1, 4
+	LD V2, 4
+	DRW V1, V2, 5
+	LD V1, 20
+	DRW V1, V2, 5
+	CLS
+	LD V0, 7
+	LD F, V0
+	DRW V2, V2, 5
+end:
+	JP end
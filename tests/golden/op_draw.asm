@@ -0,0 +1,18 @@
+; DXYN: a sprite from memory, the same sprite again over part of it (collision),
+; then one that misses (no collision)
+	LD I, box
+	LD V0, 10
+	LD V1, 6
+	DRW V0, V1, 4
+	LD V2, VF
+	LD V0, 12
+	DRW V0, V1, 4
+	LD V3, VF
+	LD V0, 40
+	DRW V0, V1, 4
+	LD V4, VF
+end:
+	JP end
+
+box:
+	DB 0xFF, 0x81, 0x81, 0xFF
@@ -0,0 +1,17 @@
+; FX29 / FX33: BCD of 254 at I, read back into V0-V2 and kept in V8-VA,
+; then the first row of digit C from its font address
+	LD V0, 254
+	LD I, digits
+	LD B, V0
+	LD V2, [I]
+	LD V8, V0
+	LD V9, V1
+	LD VA, V2
+	LD V4, 0xC
+	LD F, V4
+	LD V0, [I]
+end:
+	JP end
+
+digits:
+	DB 0, 0, 0
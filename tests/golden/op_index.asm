@@ -0,0 +1,9 @@
+; ANNN / FX1E: I is set, then advanced twice (past 0xFFF on purpose)
+	LD I, 0x123
+	LD V0, 0x45
+	ADD I, V0
+	LD V1, 0xFF
+	LD I, 0xFF0
+	ADD I, V1
+end:
+	JP end
@@ -0,0 +1,12 @@
+; 1NNN: forward and backward jumps over instructions that would mark V0
+	JP forward
+	LD V0, 0xBA
+back:
+	LD V2, 2
+	JP end
+	LD V0, 0xBB
+forward:
+	LD V1, 1
+	JP back
+end:
+	JP end
@@ -0,0 +1,6 @@
+; FX0A with key 9 held: returns it straight away
+	LD V0, 0xEE
+	LD V0, K
+	LD V1, 1
+end:
+	JP end
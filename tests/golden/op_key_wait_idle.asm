@@ -0,0 +1,6 @@
+; FX0A with nothing held: stays on the instruction for the whole run
+	LD V1, 1
+	LD V0, K
+	LD V2, 2
+end:
+	JP end
@@ -0,0 +1,14 @@
+; EX9E / EXA1, run with keys 5 and A held
+	LD V0, 0x5
+	LD V1, 0x6
+	LD V2, 0xA
+	SKP V0
+	ADD V3, 1       ; skipped
+	SKP V1
+	ADD V4, 1       ; runs
+	SKNP V1
+	ADD V5, 1       ; skipped
+	SKNP V2
+	ADD V6, 1       ; runs
+end:
+	JP end
@@ -0,0 +1,11 @@
+; 6XNN / 7XNN: 7XNN wraps and never touches VF
+	LD V0, 0xFF
+	ADD V0, 2
+	LD VF, 0x77
+	ADD VF, 1
+	LD V1, 0x10
+	ADD V1, 0x20
+	LD VE, 0
+	ADD VE, 0xFF
+end:
+	JP end
@@ -0,0 +1,18 @@
+; FX55 / FX65: store V0-V3, clear them, load V0-V2 back
+	LD V0, 0x10
+	LD V1, 0x20
+	LD V2, 0x30
+	LD V3, 0x40
+	LD I, data
+	LD [I], V3
+	LD V0, 0
+	LD V1, 0
+	LD V2, 0
+	LD V3, 0
+	LD I, data
+	LD V2, [I]
+end:
+	JP end
+
+data:
+	DB 0, 0, 0, 0
@@ -0,0 +1,12 @@
+; 8XY0-8XY3
+	LD V0, 0b11001010
+	LD V1, 0b10101100
+	LD V2, V0
+	OR V2, V1
+	LD V3, V0
+	AND V3, V1
+	LD V4, V0
+	XOR V4, V1
+	LD V5, V1
+end:
+	JP end
@@ -0,0 +1,8 @@
+; CXNN: the generator's fixed default seed makes this repeatable; the masks must hold
+	RND V0, 0xFF
+	RND V1, 0x0F
+	RND V2, 0xF0
+	RND V3, 0
+	RND V4, 0xFF
+end:
+	JP end
@@ -0,0 +1,12 @@
+; 3XNN / 4XNN: each register counts the skips taken
+	LD V0, 0x5A
+	SE V0, 0x5A
+	ADD V1, 1       ; skipped
+	SE V0, 0x5B
+	ADD V2, 1       ; runs
+	SNE V0, 0x5A
+	ADD V3, 1       ; runs
+	SNE V0, 0x00
+	ADD V4, 1       ; skipped
+end:
+	JP end
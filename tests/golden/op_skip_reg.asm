@@ -0,0 +1,14 @@
+; 5XY0 / 9XY0
+	LD V0, 0x33
+	LD V1, 0x33
+	LD V2, 0x34
+	SE V0, V1
+	ADD V3, 1       ; skipped
+	SE V0, V2
+	ADD V4, 1       ; runs
+	SNE V0, V2
+	ADD V5, 1       ; skipped
+	SNE V0, V1
+	ADD V6, 1       ; runs
+end:
+	JP end
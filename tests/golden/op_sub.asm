@@ -0,0 +1,17 @@
+; 8XY5 / 8XY7: borrow and no borrow, copies of VF after each
+	LD V0, 0x10
+	LD V1, 0x30
+	SUB V0, V1
+	LD V2, VF
+	LD V3, 0x30
+	LD V4, 0x10
+	SUB V3, V4
+	LD V5, VF
+	LD V6, 0x10
+	SUBN V6, V1
+	LD V7, VF
+	LD V8, 0x30
+	SUBN V8, V4
+	LD V9, VF
+end:
+	JP end
@@ -0,0 +1,12 @@
+; FX15 / FX18 / FX07: timers count down once a frame; V1 polls DT until it's 0
+	LD V0, 20
+	LD DT, V0
+	LD V0, 40
+	LD ST, V0
+wait:
+	LD V1, DT
+	SE V1, 0
+	JP wait
+	LD V2, 0x99
+end:
+	JP end
@@ -0,0 +1,15 @@
+; DXYN at the bottom right corner: CHIP-8 and SUPER-CHIP clip, XO-CHIP wraps round
+	LD I, block
+	LD V0, 60
+	LD V1, 29
+	DRW V0, V1, 6
+	LD V2, VF
+	LD V0, 0
+	LD V1, 0
+	DRW V0, V1, 1
+	LD V3, VF
+end:
+	JP end
+
+block:
+	DB 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
@@ -0,0 +1,8 @@
+; DXYN: CHIP-8 draws at most once a frame, the others don't wait. V5 counts draws.
+	LD V0, 0
+	LD V1, 0
+	LD F, V0
+loop:
+	DRW V0, V1, 5
+	ADD V5, 1
+	JP loop
@@ -0,0 +1,13 @@
+; BNNN: CHIP-8 and XO-CHIP add V0, SUPER-CHIP reads it as BXNN and adds VX (V2 here)
+	LD V0, 0
+	LD V2, 4
+	JP V0, target
+end:
+	JP end
+
+	ORG 0x240
+target:
+	LD V5, 0xC8
+	JP end
+	LD V5, 0x5C
+	JP end
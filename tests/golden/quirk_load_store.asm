@@ -0,0 +1,16 @@
+; FX55 / FX65: CHIP-8 and XO-CHIP leave I past the registers, SUPER-CHIP leaves it alone.
+; V5 and V6 read back whatever I ends up at.
+	LD V0, 0xA0
+	LD V1, 0xA1
+	LD V2, 0xA2
+	LD I, data
+	LD [I], V2
+	LD V5, [I]
+	LD I, data
+	LD V1, [I]
+	LD V6, V0
+end:
+	JP end
+
+data:
+	DB 0, 0, 0, 0xD3, 0xD4, 0xD5, 0xD6
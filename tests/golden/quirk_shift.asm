@@ -0,0 +1,11 @@
+; 8XY6 / 8XYE: CHIP-8 and XO-CHIP shift VY into VX, SUPER-CHIP shifts VX in place
+	LD V0, 0x81
+	LD V1, 0x06
+	SHR V0, V1
+	LD V2, VF
+	LD V3, 0x81
+	LD V4, 0x60
+	SHL V3, V4
+	LD V5, VF
+end:
+	JP end
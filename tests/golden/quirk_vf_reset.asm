@@ -0,0 +1,14 @@
+; 8XY1-8XY3: only CHIP-8 resets VF. Each result's VF is copied out.
+	LD V0, 0x0F
+	LD V1, 0xF0
+	LD VF, 0x55
+	OR V0, V1
+	LD V2, VF
+	LD VF, 0x55
+	AND V0, V1
+	LD V3, VF
+	LD VF, 0x55
+	XOR V0, V1
+	LD V4, VF
+end:
+	JP end
@@ -0,0 +1,28 @@
+; SUPER-CHIP: hi-res, a 16x16 sprite, the big font, scrolling, flag registers and exit
+	HIGH
+	LD I, big
+	LD V0, 100
+	LD V1, 40
+	DRW V0, V1, 0
+	LD V2, 9
+	LD HF, V2
+	LD V0, 4
+	LD V1, 4
+	DRW V0, V1, 10
+	SCD 3
+	SCR
+	SCL
+	SCL
+	LD V0, 0x61
+	LD V1, 0x62
+	LD V2, 0x63
+	LD R, V2
+	LD V0, 0
+	LD V1, 0
+	LD V2, 0
+	LD V1, R
+	EXIT
+
+big:
+	DW 0xFFFF, 0x8001, 0x8001, 0x8001, 0x8001, 0x8001, 0x8001, 0x8001
+	DW 0x8001, 0x8001, 0x8001, 0x8001, 0x8001, 0x8001, 0x8001, 0xFFFF
@@ -0,0 +1,34 @@
+; XO-CHIP: both planes, long I, register ranges, scroll up, audio pattern and pitch,
+; and a skip over the 4-byte F000 NNNN
+	PLANE 3
+	LD I, LONG sprites
+	LD V0, 8
+	LD V1, 8
+	DRW V0, V1, 4
+	SCU 2
+	PLANE 2
+	CLS
+	PLANE 1
+	LD V0, 0x71
+	LD V1, 0x72
+	LD V2, 0x73
+	LD I, LONG 0x1000
+	SAVE V0, V2
+	LOAD V2, V0
+	LD I, pattern
+	AUDIO
+	LD V3, 0x80
+	PITCH V3
+	LD V4, 1
+	SE V4, 1
+	LD I, LONG 0x2345
+	LD V5, 0x55
+end:
+	JP end
+
+sprites:
+	DB 0xF0, 0x90, 0x90, 0xF0
+	DB 0xFF, 0x00, 0xFF, 0x00
+pattern:
+	DB 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF
+	DB 0x0F, 0x0F, 0x0F, 0x0F, 0xF0, 0xF0, 0xF0, 0xF0
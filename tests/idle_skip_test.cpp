@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assembler.h"
+#include "chip8.h"
+
+// Idle-loop skipping must not change what the machine does: a run with it
+// (Run<false>) and one without (Run<true>, which never probes for idle loops)
+// have to agree on the whole state and the instruction count after every
+// frame, for budgets that end at every phase of the polling loop.
+
+// Polls the delay timer, then draws and starts the next wait
+static const char* timerPolling = R"(
+	LD V0, 3
+	LD V3, 10
+loop:
+	LD DT, V0
+	ADD V1, 1
+wait:
+	LD V2, DT
+	SE V2, 0
+	JP wait
+	LD F, V1
+	DRW V3, V3, 5
+	ADD V3, 1
+	JP loop
+)";
+
+// Polls key 5 with SKP until it goes down and SKNP until it comes up, then
+// waits for another key with FX0A
+static const char* keyPolling = R"(
+	LD V4, 5
+down:
+	SKP V4
+	JP down
+	ADD V5, 1
+up:
+	SKNP V4
+	JP up
+	LD V6, K
+	ADD V7, V6
+	JP down
+)";
+
+static bool Load(const char* source, Chip8& chip8)
+{
+	Assembler assembler;
+	std::vector<uint8_t> rom;
+	std::string error;
+	if (!assembler.Assemble(source, rom, error)) {
+		std::cout << "Assembly failed: " << error << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < rom.size(); ++i) {
+		chip8.Write(static_cast<uint16_t>(PC_START_ADDRESS + i), rom[i]);
+	}
+	return true;
+}
+
+// Key 5 goes down and up, and other keys are pressed for FX0A, at fixed frames
+static void Keys(Chip8& chip8, unsigned int frame)
+{
+	switch (frame % 40) {
+		case 5:  chip8.SetKey(5, true);  break;
+		case 9:  chip8.SetKey(5, false); break;
+		case 20: chip8.SetKey(0xA, true); break;
+		case 21: chip8.SetKey(0xA, false); break;
+	}
+}
+
+static bool Compare(const char* name, const char* source, int cyclesPerFrame)
+{
+	Chip8 skipping, plain;
+	if (!Load(source, skipping) || !Load(source, plain)) return false;
+
+	uint64_t skippingExecuted = 0, plainExecuted = 0;
+	for (unsigned int frame = 0; frame < 300; ++frame) {
+		Keys(skipping, frame);
+		Keys(plain, frame);
+
+		skippingExecuted += skipping.Run<false>(cyclesPerFrame);
+		plainExecuted += plain.Run<true>(cyclesPerFrame);
+
+		if (skipping.pc != plain.pc || skipping.StateHash() != plain.StateHash() || skippingExecuted != plainExecuted) {
+			std::cout << "FAIL " << name << " at " << cyclesPerFrame << " cycles/frame: frame " << frame
+				<< " pc " << std::hex << skipping.pc << " vs " << plain.pc << std::dec
+				<< ", executed " << skippingExecuted << " vs " << plainExecuted << std::endl;
+			return false;
+		}
+
+		skipping.TickTimers();
+		plain.TickTimers();
+	}
+	return true;
+}
+
+int main()
+{
+	int failures = 0;
+	for (int cycles = 1; cycles <= 16; ++cycles) {
+		if (!Compare("timer polling", timerPolling, cycles)) ++failures;
+		if (!Compare("key polling", keyPolling, cycles)) ++failures;
+	}
+	std::cout << (failures ? "FAIL" : "PASS") << " idle skipping matches plain execution" << std::endl;
+	return failures ? 1 : 0;
+}
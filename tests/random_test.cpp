@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assembler.h"
+#include "chip8.h"
+
+// CXNN's generator is part of the machine: a copy carries on with the same
+// numbers, a seed always gives the same ones, and machines seeded differently
+// don't share a sequence.
+
+// Draws a byte per loop iteration and stores it at I, walking I through memory
+static const char* randomBytes = R"(
+	LD I, 0x400
+	LD V1, 1
+loop:
+	RND V0, 0xFF
+	LD [I], V0
+	ADD I, V1
+	JP loop
+)";
+
+static bool Load(Chip8& chip8)
+{
+	Assembler assembler;
+	std::vector<uint8_t> rom;
+	std::string error;
+	if (!assembler.Assemble(randomBytes, rom, error)) {
+		std::cout << "Assembly failed: " << error << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < rom.size(); ++i) {
+		chip8.Write(static_cast<uint16_t>(PC_START_ADDRESS + i), rom[i]);
+	}
+	return true;
+}
+
+// The first `count` bytes the program stored
+static std::vector<uint8_t> Drawn(Chip8& chip8, size_t count)
+{
+	chip8.Run<false>(static_cast<int>(2 + count * 4));
+	std::vector<uint8_t> bytes(count);
+	chip8.memory.Copy(0x400, bytes.data(), bytes.size());
+	return bytes;
+}
+
+static bool Expect(const char* name, bool passed)
+{
+	if (!passed) std::cout << "FAIL " << name << std::endl;
+	return passed;
+}
+
+int main()
+{
+	int failures = 0;
+	const size_t COUNT = 256;
+
+	// The same seed gives the same bytes, including seed 0
+	for (uint64_t seed : { 0ull, 1ull, 0x123456789ABCDEFull }) {
+		Random a, b;
+		a.Seed(seed);
+		b.Seed(seed);
+		bool same = true, nonZero = false;
+		for (size_t i = 0; i < COUNT; ++i) {
+			uint64_t value = a.Next();
+			same = same && value == b.Next();
+			nonZero = nonZero || value != 0;
+		}
+		if (!Expect("same seed, same sequence", same && a.state == b.state)) ++failures;
+		if (!Expect("seed does not stick at zero", nonZero)) ++failures;
+	}
+
+	// A copy taken mid-run draws what the original goes on to draw
+	Chip8 original;
+	if (!Load(original)) return 1;
+	original.random.Seed(42);
+	original.Run<false>(2 + 10 * 4);
+	Chip8 copy = original;
+	original.Run<false>(static_cast<int>(COUNT * 4));
+	copy.Run<false>(static_cast<int>(COUNT * 4));
+	std::vector<uint8_t> originalBytes(COUNT), copyBytes(COUNT);
+	original.memory.Copy(0x400, originalBytes.data(), COUNT);
+	copy.memory.Copy(0x400, copyBytes.data(), COUNT);
+	if (!Expect("copy continues the sequence", originalBytes == copyBytes && original.random.state == copy.random.state)) ++failures;
+
+	// Reseeding replays a run, and another seed gives other numbers
+	Chip8 first, again, other;
+	if (!Load(first) || !Load(again) || !Load(other)) return 1;
+	first.random.Seed(7);
+	again.random.Seed(7);
+	other.random.Seed(8);
+	std::vector<uint8_t> firstBytes = Drawn(first, COUNT);
+	if (!Expect("same seed, same CXNN results", firstBytes == Drawn(again, COUNT))) ++failures;
+	if (!Expect("other seed, other CXNN results", firstBytes != Drawn(other, COUNT))) ++failures;
+
+	std::cout << (failures ? "FAIL" : "PASS") << " per-machine random generator" << std::endl;
+	return failures ? 1 : 0;
+}